@@ -36,6 +36,90 @@ int32_t app_publish(const char * topic, const struct fbp_union_s * value,
 int32_t app_meta(const char * topic, const char * meta_json);
 int32_t app_query(const char * topic, struct fbp_union_s * value);
 
+/// The maximum number of app_subscribe_throttled() subscriptions.
+#define APP_SUBSCRIBE_THROTTLE_MAX (8)
+
+/// The number of topics throttled at once, shared by all subscriptions.
+#define APP_SUBSCRIBE_THROTTLE_SLOTS (16)
+
+/**
+ * @brief Subscribe with a minimum interval between deliveries.
+ *
+ * @param topic The topic, without the pubsub topic_prefix.
+ * @param flags The FBP_PUBSUB_SFLAG_* flags.
+ * @param interval_ms The minimum time between cbk_fn calls, in milliseconds.
+ * @param cbk_fn The callback function.
+ * @param cbk_user_data The arbitrary data for cbk_fn.
+ * @return 0 or error code.
+ *
+ * Each topic under the subscription is throttled on its own.  The pubsub
+ * task delivers the first value of a topic immediately.  It holds later
+ * values that arrive within interval_ms and delivers only the latest one
+ * once the interval expires.  The per-topic state comes from a pool of
+ * APP_SUBSCRIBE_THROTTLE_SLOTS that is reclaimed once a topic is idle for
+ * interval_ms.  When the pool is exhausted, values pass unthrottled.
+ * String, JSON and binary values are never held.  Throttled subscriptions
+ * cannot be unsubscribed.
+ */
+int32_t app_subscribe_throttled(const char * topic, uint8_t flags, uint32_t interval_ms,
+                                fbp_pubsub_subscribe_fn cbk_fn, void * cbk_user_data);
+
+/// Keep only the latest pending value, see app_topic_flags_set().
+#define APP_TOPIC_FLAG_COALESCE (1 << 0)
+
+/// The maximum number of topics with APP_TOPIC_FLAG_COALESCE.
+#define APP_TOPIC_COALESCE_MAX (16)
+
+/**
+ * @brief A topic resolved once by app_topic_resolve().
+ *
+ * Services that publish frequently keep a static handle so that
+ * each publish skips the prefix string construction.
+ * The handle must remain valid for the program lifetime.
+ */
+struct app_topic_s {
+    char topic[FBP_PUBSUB_TOPIC_LENGTH_MAX];  ///< The full topic with prefix.
+    uint8_t flags;                            ///< The APP_TOPIC_FLAG_* bits.
+    volatile uint8_t pending;                 ///< value awaits the pubsub task.
+    struct fbp_union_s value;                 ///< The latest coalesced value.
+    fbp_pubsub_subscribe_fn src_fn;           ///< The latest coalesced source.
+    void * src_user_data;
+    struct app_topic_s * next;                ///< The next coalescing topic.
+};
+
+/**
+ * @brief Resolve a topic, without prefix, into a handle.
+ *
+ * @param handle[out] The handle to populate, which must start zeroed.
+ * @param topic The topic, without the pubsub topic_prefix.
+ * @return 0 or FBP_ERROR_PARAMETER_INVALID if topic is too long.
+ *      Resolving an already resolved handle again keeps its flags and
+ *      returns FBP_ERROR_PARAMETER_INVALID if topic differs.
+ */
+int32_t app_topic_resolve(struct app_topic_s * handle, const char * topic);
+
+/**
+ * @brief Set the topic flags.
+ *
+ * @param handle The resolved topic handle.
+ * @param flags The APP_TOPIC_FLAG_* bits.
+ * @return 0 or FBP_ERROR_FULL.
+ *
+ * With APP_TOPIC_FLAG_COALESCE, publishing a scalar value only records it
+ * as pending.  The pubsub task publishes the latest pending value once
+ * per wakeup, so intermediate values never enter the pubsub buffer or
+ * the links.  This applies to app_publish() and app_publish_h().
+ * Coalescing cannot be cleared once set.
+ */
+int32_t app_topic_flags_set(struct app_topic_s * handle, uint8_t flags);
+
+/// Handle versions of the wrappers above, with no string work.
+int32_t app_subscribe_h(const struct app_topic_s * topic, uint8_t flags,
+                        fbp_pubsub_subscribe_fn cbk_fn, void * cbk_user_data);
+int32_t app_publish_h(struct app_topic_s * topic, const struct fbp_union_s * value,
+                      fbp_pubsub_subscribe_fn src_fn, void * src_user_data);
+int32_t app_query_h(const struct app_topic_s * topic, struct fbp_union_s * value);
+
 
 /**
  * @brief Construct and initialize the pubsub instance.
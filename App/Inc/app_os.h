@@ -0,0 +1,135 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Task, mutex and memory allocation for the static build mode.
+ *
+ * With APP_STATIC_ALLOC, each task stack and TCB is a static object
+ * in the module that creates the task, mutexes come from a static
+ * pool, and the fitterbap allocations, such as the evm instances,
+ * the fbp_dl windows and the PubSub buffer, come from a static bump
+ * pool of APP_POOL_SIZE bytes.  The linker map then shows the RAM
+ * used by each module, see tools/ram_budget.py.  Only the kernel
+ * objects that fitterbap and CMSIS-RTOS create internally remain on
+ * the FreeRTOS heap, which shrinks to APP_STATIC_HEAP_SIZE bytes, see
+ * Core/Inc/FreeRTOSConfig.h.
+ *
+ * Without APP_STATIC_ALLOC, everything comes from the FreeRTOS heap.
+ */
+
+#ifndef APP_STM32G4_APP_OS_H__
+#define APP_STM32G4_APP_OS_H__
+
+#include "fitterbap/os/mutex.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef APP_STATIC_ALLOC
+#define APP_STATIC_ALLOC 0
+#endif
+
+/// The static pool size for fitterbap allocations, in bytes.
+#ifndef APP_POOL_SIZE
+#define APP_POOL_SIZE (73728)
+#endif
+
+/// The maximum number of mutexes from app_mutex_alloc(), 7 in use.
+#ifndef APP_MUTEX_MAX
+#define APP_MUTEX_MAX (8)
+#endif
+
+/// The minimum free FreeRTOS heap after startup, see app_heap_check().
+#ifndef APP_STATIC_HEAP_MARGIN
+#define APP_STATIC_HEAP_MARGIN (512)
+#endif
+
+#if APP_STATIC_ALLOC
+/// Declare the static memory for a task, stack_depth in 32-bit words.
+#define APP_TASK_MEMORY(name, stack_depth) \
+    static StackType_t name##_stack_[stack_depth]; \
+    static StaticTask_t name##_tcb_
+#define APP_TASK_STACK(name) (name##_stack_)
+#define APP_TASK_TCB(name) (&name##_tcb_)
+#else
+#define APP_TASK_MEMORY(name, stack_depth) struct app_task_memory_##name##_s
+#define APP_TASK_STACK(name) (NULL)
+#define APP_TASK_TCB(name) (NULL)
+#endif
+
+/**
+ * @brief Create a task.
+ *
+ * @param fn The task function.
+ * @param name The task name.
+ * @param stack_depth The stack size in 32-bit words.
+ * @param parameters The arbitrary data for fn.
+ * @param priority The task priority.
+ * @param[out] handle The task handle.
+ * @param stack The stack, APP_TASK_STACK(), with stack_depth words.
+ * @param tcb The task control block, APP_TASK_TCB().
+ * @return pdTRUE on success, like xTaskCreate().
+ *
+ * Without APP_STATIC_ALLOC, stack and tcb are NULL and the task
+ * comes from the FreeRTOS heap.
+ */
+BaseType_t app_task_create(TaskFunction_t fn, const char * name, uint16_t stack_depth,
+                           void * parameters, UBaseType_t priority, TaskHandle_t * handle,
+                           StackType_t * stack, StaticTask_t * tcb);
+
+/**
+ * @brief Allocate a mutex for use with the fitterbap mutex API.
+ *
+ * @return The mutex.  This function does not return on failure.
+ */
+fbp_os_mutex_t app_mutex_alloc();
+
+/**
+ * @brief Check the FreeRTOS heap headroom.
+ *
+ * Call once from a task after the scheduler starts, when the kernel
+ * has created its own objects.  With APP_STATIC_ALLOC, this function
+ * does not return when less than APP_STATIC_HEAP_MARGIN bytes remain,
+ * which means that APP_STATIC_HEAP_SIZE is too small.
+ */
+void app_heap_check();
+
+/**
+ * @brief Allocate from the static pool.
+ *
+ * @param size_bytes The size in bytes.
+ * @return The 8-byte aligned memory or NULL when the pool is exhausted.
+ */
+void * app_pool_alloc(uint32_t size_bytes);
+
+/**
+ * @brief Get the remaining static pool size.
+ *
+ * @return The free pool size in bytes, which is 0 without APP_STATIC_ALLOC.
+ */
+uint32_t app_pool_free();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_APP_OS_H__ */
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2020-2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief CRC-32 backends for the framer, see FBP_FRAMER_CRC32.
+ *
+ * All backends compute the same IEEE 802.3 CRC-32 as fbp_crc32().
+ */
+
+#ifndef APP_STM32G4_CRC32_H__
+#define APP_STM32G4_CRC32_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the CRC backends.
+ *
+ * Call once before the scheduler starts and before any app_crc32() call.
+ */
+void crc32_initialize();
+
+/**
+ * @brief Compute the CRC-32 using the fastest available backend.
+ *
+ * @param crc The CRC from the previous call or 0 to start.
+ * @param data The data.
+ * @param length The size of data in bytes.
+ * @return The CRC-32.
+ *
+ * This function is thread-safe, but MUST NOT be called from an ISR.
+ */
+uint32_t app_crc32(uint32_t crc, uint8_t const * data, uint32_t length);
+
+/**
+ * @brief Compute the CRC-32 in software using slicing-by-8 tables.
+ *
+ * @param crc The CRC from the previous call or 0 to start.
+ * @param data The data.
+ * @param length The size of data in bytes.
+ * @return The CRC-32.
+ *
+ * Call crc32_sw_initialize() first, which builds the 8 kB of tables.
+ * The target uses the CRC unit, so only its benchmark builds and
+ * links the tables.  The host build uses this backend for app_crc32().
+ */
+uint32_t crc32_sw(uint32_t crc, uint8_t const * data, uint32_t length);
+
+/**
+ * @brief Compute the CRC-32 in software, 4 bits at a time.
+ *
+ * @param crc The CRC from the previous call or 0 to start.
+ * @param data The data.
+ * @param length The size of data in bytes.
+ * @return The CRC-32.
+ *
+ * Slow, but the 64-byte table is const, so this function is safe to
+ * call at any time, even before crc32_initialize() or from fbp_fatal().
+ */
+uint32_t crc32_sw_small(uint32_t crc, uint8_t const * data, uint32_t length);
+
+/// Build the crc32_sw() tables, see crc32_sw().
+void crc32_sw_initialize();
+
+/**
+ * @brief Log the cycles per byte for each backend.
+ *
+ * Does nothing unless CRC32_BENCHMARK is enabled in crc32.c.
+ */
+void crc32_benchmark();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_CRC32_H__ */
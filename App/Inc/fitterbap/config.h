@@ -43,13 +43,26 @@
 /* Set the initial comm log port level for forwarding/receiving log messages. */
 #define FBP_LOGP_LEVEL FBP_LOG_LEVEL_INFO
 
+/* Set to 1 to record binary logs for host decoding, see log_bin.h */
+#ifndef APP_LOG_BINARY
+#define APP_LOG_BINARY 0
+#endif
+
 /* Override the log format */
+#if APP_LOG_BINARY
+#include "log_bin.h"
+#define FBP_LOG_PRINTF(level, format, ...) \
+    LOG_BIN_PUBLISH(level, format, __VA_ARGS__)
+#else
 struct fbp_logh_s;
 int32_t fbp_logh_publish(struct fbp_logh_s * self, uint8_t level, const char * filename, uint32_t line, const char * format, ...);
 #define FBP_LOG_PRINTF(level, format, ...) \
     fbp_logh_publish(NULL, level, __FILENAME__, __LINE__, format, __VA_ARGS__)
+#endif
 
-#define FBP_FRAMER_CRC32 fbp_crc32
+/* Use the CRC unit on the target, slicing-by-8 on the host, see crc32.h */
+uint32_t app_crc32(uint32_t crc, uint8_t const * data, uint32_t length);
+#define FBP_FRAMER_CRC32 app_crc32
 #define FBP_CRC_CRC32 1
 
 #define FBP_PLATFORM_STDLIB 1
@@ -17,14 +17,34 @@
 #ifndef FBP_EXAMPLE_STM32G4_FITTERBAP_SUPPORT_H__
 #define FBP_EXAMPLE_STM32G4_FITTERBAP_SUPPORT_H__
 
+#include "fitterbap/time.h"
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Initialize the fitterbap platform support.
+ *
+ * Registers the allocator and starts the 64-bit time counter used by
+ * fbp_time_counter(), so call this before any other fitterbap module.
+ */
 void fitterbap_support_initialize();
 
+/**
+ * @brief Get the high-resolution 64-bit time counter.
+ *
+ * @return The counter, which starts near 0 at
+ *      fitterbap_support_initialize().  It runs at 170 MHz on the
+ *      target and 1 GHz on the host.
+ *
+ * Use this counter for short intervals and timestamps within the app.
+ * fbp_time_counter() counts the same time at 1 kHz, so that fitterbap
+ * can convert its values to FBP_TIME without overflow.
+ */
+struct fbp_time_counter_s fitterbap_support_counter();
+
 
 #ifdef __cplusplus
 }
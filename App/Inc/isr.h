@@ -43,6 +43,8 @@ extern "C" {
 FBP_STATIC_ASSERT(5 == configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, isr_most_urgent_priority);
 FBP_STATIC_ASSERT(15 == configLIBRARY_LOWEST_INTERRUPT_PRIORITY, isr_least_urgent_priority);
 
+#define ISR_TIME            (5)   // TIM2 wrap, extends fitterbap_support_counter()
+
 #define ISR_UART1_DMA_RX    (10)
 #define ISR_UART1_DMA_TX    (11)
 #define ISR_UART1           (15)  // rx timeout
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Deferred binary logging.
+ *
+ * With APP_LOG_BINARY, the FBP_LOGx macros do not format text on the
+ * target.  Each call site places "format\x1f" __FILE__ "\x1f" __LINE__
+ * in the log_fmt section, and the record holds only the offset of this
+ * string, the level, a timestamp and the raw arguments.  The log task
+ * publishes batches of records to "{prefix}/log/bin".
+ * tools/log_bin_decode.py reads the log_fmt section from the ELF file
+ * and renders the records as text on the host.
+ *
+ * A record is little endian:
+ *
+ *     u8 level, u8 record size, u16 format offset, u32 time in ms,
+ *     then the arguments in format order: u32 for integers and
+ *     characters, u64 for "ll" integers and doubles, and
+ *     nul-terminated bytes for strings, up to LOG_BIN_STR_MAX.
+ */
+
+#ifndef APP_STM32G4_LOG_BIN_H__
+#define APP_STM32G4_LOG_BIN_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The log ring size in bytes, a power of 2.
+#ifndef LOG_BIN_BUFFER_SIZE
+#define LOG_BIN_BUFFER_SIZE (2048)
+#endif
+
+/// The maximum record size in bytes.
+#define LOG_BIN_RECORD_MAX (64)
+
+/// The maximum string argument size in bytes, including the terminator.
+#define LOG_BIN_STR_MAX (24)
+
+/// Separates the format, file and line in the log_fmt section.
+#define LOG_BIN_SEP '\x1f'
+
+/// The source file name stored in log_fmt, without the build host path.
+#ifdef __FILE_NAME__
+#define LOG_BIN_FILE __FILE_NAME__
+#else
+#define LOG_BIN_FILE __FILE__  // relative with -fmacro-prefix-map, see CMakeLists.txt
+#endif
+
+#define LOG_BIN_STR_(x) #x
+#define LOG_BIN_STR(x) LOG_BIN_STR_(x)
+
+/**
+ * @brief Log a binary record, used by FBP_LOG_PRINTF.
+ *
+ * @param level The fitterbap log level.
+ * @param format The printf-style format string literal.
+ */
+#define LOG_BIN_PUBLISH(level, format, ...) do {                                \
+    static const char log_bin_fmt_[] __attribute__((section("log_fmt"), used)) \
+        = format "\x1f" LOG_BIN_FILE "\x1f" LOG_BIN_STR(__LINE__);              \
+    log_bin_publish(level, log_bin_fmt_, __VA_ARGS__);                          \
+} while (0)
+
+/**
+ * @brief The function called when records are ready to send.
+ *
+ * @param user_data The arbitrary data.
+ */
+typedef void (*log_bin_on_publish)(void * user_data);
+
+/**
+ * @brief Initialize the log ring.
+ *
+ * The ring is in .noinit RAM.  When it holds valid records from
+ * before the last reset, this function keeps them for replay.
+ * Records published before this call are dropped.  Without
+ * APP_LOG_BINARY, there is no ring and only the fatal error from
+ * log_bin_fatal() survives the reset.
+ */
+void log_bin_initialize();
+
+/**
+ * @brief Record a fatal error that survives the reset.
+ *
+ * @param file The source file.
+ * @param line The source line.
+ * @param msg The message.
+ *
+ * Call from fbp_fatal().  On the next boot, log_bin_process()
+ * publishes the error to "{prefix}/log/fatal" and the surviving
+ * records to "{prefix}/log/bin".
+ */
+void log_bin_fatal(const char * file, uint32_t line, const char * msg);
+
+/**
+ * @brief Add a record to the log ring.
+ *
+ * @param level The fitterbap log level.
+ * @param fmt The format from the log_fmt section, see LOG_BIN_PUBLISH.
+ * @return 0 or FBP_ERROR_FULL when the record was dropped.
+ *
+ * Safe to call from any task or ISR, see log_ring.h.
+ */
+int32_t log_bin_publish(uint8_t level, const char * fmt, ...);
+
+/**
+ * @brief Register the function called when the log ring fills.
+ *
+ * @param fn The function, which should schedule log_bin_process().
+ *      Since records may come from ISRs, fn must be ISR-safe.
+ * @param user_data The arbitrary data for fn.
+ */
+void log_bin_publish_register(log_bin_on_publish fn, void * user_data);
+
+/**
+ * @brief Publish the pending records.
+ *
+ * @return 0 or the app_publish() error when records remain, in which
+ *      case call again shortly.
+ *
+ * Call from a single task, such as the log task.  Records leave the
+ * ring only after they are published.  While publishing fails, new
+ * records that do not fit are counted in "{prefix}/log/drops".
+ */
+int32_t log_bin_process();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_LOG_BIN_H__ */
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Lock-free multiple producer, single consumer record ring.
+ *
+ * Producers reserve space with a compare-and-swap on head, fill the
+ * record, and then commit it.  Producers may be tasks or ISRs, and
+ * an ISR may preempt a producer between reserve and commit.  The
+ * consumer stops at the first uncommitted record, so records are
+ * always removed in reservation order.
+ *
+ * Each record starts with a 32-bit header and is padded to 32 bits.
+ * A record never wraps: when the space to the end of the buffer is
+ * too small, the producer also reserves that space as padding.  The
+ * consumer zeros each record it removes, so that free space never
+ * contains a stale committed header.
+ */
+
+#ifndef APP_STM32G4_LOG_RING_H__
+#define APP_STM32G4_LOG_RING_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The record ring instance, treat as opaque.
+struct log_ring_s {
+    volatile uint32_t head;     ///< The reserved byte count, free running.
+    volatile uint32_t tail;     ///< The removed byte count, free running.
+    volatile uint32_t drops;    ///< The number of records that did not fit.
+    uint32_t size;              ///< The buffer size in bytes, a power of 2.
+    uint32_t * buffer;
+};
+
+/**
+ * @brief Initialize a ring.
+ *
+ * @param self The instance to initialize.
+ * @param buffer The record storage.
+ * @param size The buffer size in bytes, which must be a power of 2.
+ */
+void log_ring_initialize(struct log_ring_s * self, uint32_t * buffer, uint32_t size);
+
+/**
+ * @brief Recover a ring that survived a reset.
+ *
+ * @param self The instance, which is in memory that the startup code
+ *      does not initialize.
+ * @param buffer The record storage.
+ * @param size The buffer size in bytes, which must be a power of 2.
+ * @return The number of recovered records.
+ *
+ * Keeps the committed records from tail up to the first uncommitted
+ * or invalid record.  When the ring state is invalid, this function
+ * initializes the ring and returns 0.
+ */
+uint32_t log_ring_recover(struct log_ring_s * self, uint32_t * buffer, uint32_t size);
+
+/**
+ * @brief Reserve a record.
+ *
+ * @param self The instance.
+ * @param size The record size in bytes.
+ * @return The contiguous record storage, which must be passed to
+ *      log_ring_commit(), or NULL when full.  On NULL, the drop
+ *      count increments.
+ *
+ * Safe to call from any task or ISR.
+ */
+uint8_t * log_ring_reserve(struct log_ring_s * self, uint32_t size);
+
+/**
+ * @brief Commit a reserved record.
+ *
+ * @param self The instance.
+ * @param record The value returned by log_ring_reserve().
+ * @param size The size passed to log_ring_reserve().
+ */
+void log_ring_commit(struct log_ring_s * self, uint8_t * record, uint32_t size);
+
+/**
+ * @brief Get the oldest committed record.
+ *
+ * @param self The instance.
+ * @param[out] size The record size in bytes.
+ * @return The record or NULL when the oldest record is not yet
+ *      committed or the ring is empty.
+ *
+ * Only the single consumer may call this function.
+ */
+uint8_t * log_ring_peek(struct log_ring_s * self, uint32_t * size);
+
+/**
+ * @brief Get the committed record after a peeked record.
+ *
+ * @param self The instance.
+ * @param record The record from log_ring_peek() or this function.
+ * @param[out] size The record size in bytes.
+ * @return The next record or NULL when the next record is not yet
+ *      committed or the ring has no more records.
+ *
+ * Use with log_ring_peek() to read several records before removing
+ * them.  Only the single consumer may call this function.
+ */
+uint8_t * log_ring_peek_next(struct log_ring_s * self, const uint8_t * record, uint32_t * size);
+
+/**
+ * @brief Remove the record returned by log_ring_peek().
+ *
+ * @param self The instance.
+ */
+void log_ring_pop(struct log_ring_s * self);
+
+/**
+ * @brief Get the reserved size.
+ *
+ * @param self The instance.
+ * @return The number of reserved bytes including headers and padding.
+ */
+uint32_t log_ring_fill(struct log_ring_s * self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_LOG_RING_H__ */
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Prefix routing table for multi-board topologies.
+ *
+ * Each board owns one topic prefix, 'a' to 'h'.  Neighbors exchange
+ * distance vectors, one hop count per prefix, over each comm port.
+ * The table then selects the single next-hop port for each prefix.
+ * Vectors use split horizon with poisoned reverse, and hop counts
+ * saturate at ROUTE_HOPS_MAX, so a ring converges without routing
+ * loops.  Traffic for all boards uses reverse-path forwarding:
+ * a board accepts it only on its best port toward the source, which
+ * stops copies from circulating around a ring.
+ *
+ * The table holds no pointers and never allocates.  The caller
+ * moves the vectors across the links.
+ */
+
+#ifndef APP_STM32G4_ROUTE_H__
+#define APP_STM32G4_ROUTE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The number of board prefixes, 'a' to 'h'.
+#define ROUTE_PREFIX_COUNT (8)
+
+/// The number of comm ports, which must match UART_COUNT, see route.c.
+#define ROUTE_PORT_COUNT (5)
+
+/// The hop count for an unreachable prefix.
+#define ROUTE_HOPS_MAX (15)
+
+/// The port value for no route, including the local prefix.
+#define ROUTE_PORT_NONE (0xff)
+
+/// The route instance, treat as opaque.
+struct route_s {
+    uint8_t prefix;                     ///< The local prefix index.
+    uint8_t port_up;                    ///< The connected ports, bit mask.
+    uint8_t port[ROUTE_PREFIX_COUNT];   ///< The next-hop port for each prefix.
+    uint8_t hops[ROUTE_PREFIX_COUNT];   ///< The hop count for each prefix.
+    /// The most recent vector received on each port.
+    uint8_t neighbor[ROUTE_PORT_COUNT][ROUTE_PREFIX_COUNT];
+};
+
+/**
+ * @brief Initialize a routing table.
+ *
+ * @param self The instance to initialize.
+ * @param prefix The local prefix character, 'a' to 'h'.
+ * @return 0 or FBP_ERROR_PARAMETER_INVALID.
+ */
+int32_t route_initialize(struct route_s * self, char prefix);
+
+/**
+ * @brief Update a port's connection state.
+ *
+ * @param self The instance.
+ * @param port The port index, 0 to ROUTE_PORT_COUNT - 1.
+ * @param up 1 when the link connects, 0 when it disconnects.
+ * @return 1 if the table changed, otherwise 0.
+ *
+ * On a change, send route_advertise() on all connected ports.
+ */
+int32_t route_port_set(struct route_s * self, uint8_t port, int up);
+
+/**
+ * @brief Get the distance vector to send on a port.
+ *
+ * @param self The instance.
+ * @param port The port index.
+ * @param hops[out] The ROUTE_PREFIX_COUNT hop counts.
+ */
+void route_advertise(struct route_s * self, uint8_t port, uint8_t * hops);
+
+/**
+ * @brief Process the distance vector received from a neighbor.
+ *
+ * @param self The instance.
+ * @param port The port index that received hops.
+ * @param hops The ROUTE_PREFIX_COUNT hop counts from route_advertise().
+ * @return 1 if the table changed, otherwise 0.
+ *
+ * On a change, send route_advertise() on all connected ports.
+ */
+int32_t route_update(struct route_s * self, uint8_t port, const uint8_t * hops);
+
+/**
+ * @brief Get the next hop toward a board.
+ *
+ * @param self The instance.
+ * @param prefix The destination prefix character.
+ * @return The port index, or ROUTE_PORT_NONE if prefix is local
+ *      or unreachable.
+ */
+uint8_t route_next_hop(struct route_s * self, char prefix);
+
+/**
+ * @brief Get the ports that forward traffic intended for all boards.
+ *
+ * @param self The instance.
+ * @param prefix The source prefix character.
+ * @param port The receive port, or ROUTE_PORT_NONE for local traffic.
+ * @return The bit mask of ports to forward on.  The mask is 0 when
+ *      port is not the best path toward prefix, which suppresses
+ *      duplicates arriving around a loop.
+ */
+uint8_t route_flood_mask(struct route_s * self, char prefix, uint8_t port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_ROUTE_H__ */
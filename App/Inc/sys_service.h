@@ -0,0 +1,48 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FBP_EXAMPLE_STM32G4_SYS_SERVICE_H__
+#define FBP_EXAMPLE_STM32G4_SYS_SERVICE_H__
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+void sys_service_initialize();
+
+/**
+ * @brief Publish the FreeRTOS task statistics, once per second.
+ *
+ * Publishes the retained topics:
+ * - sys/idle: the idle task CPU load, in 0.01 %.
+ * - sys/t/{task}/cpu: the task CPU load, in 0.01 %.
+ * - sys/t/{task}/stack: the minimum free stack, in bytes.
+ * - sys/mem/heap: the free FreeRTOS heap, in bytes.
+ * - sys/mem/pool: the free static pool with APP_STATIC_ALLOC, in bytes.
+ *
+ * Only changed values are published.  Call periodically from a
+ * low-priority task.
+ */
+void sys_service_poll();
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FBP_EXAMPLE_STM32G4_SYS_SERVICE_H__ */
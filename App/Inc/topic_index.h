@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Constant-time topic lookup in a fixed arena.
+ *
+ * An open-addressed hash table maps full topic strings to an
+ * arbitrary value pointer.  The caller provides all storage, so
+ * the index never allocates and its size is known at link time.
+ * Lookup cost depends only on the topic length, not on the number
+ * of topics or the depth of the topic tree.
+ */
+
+#ifndef APP_STM32G4_TOPIC_INDEX_H__
+#define APP_STM32G4_TOPIC_INDEX_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A single table entry, treat as opaque.
+struct topic_index_entry_s {
+    uint32_t hash;      ///< The topic hash, 0 when empty.
+    uint32_t offset;    ///< The topic string offset into the arena.
+    void * value;       ///< The value for this topic.
+};
+
+/// The topic index instance, treat as opaque.
+struct topic_index_s {
+    struct topic_index_entry_s * entries;
+    uint32_t mask;
+    uint32_t count;
+    char * arena;
+    uint32_t arena_size;
+    uint32_t arena_used;
+};
+
+/**
+ * @brief Initialize a topic index.
+ *
+ * @param self The instance to initialize.
+ * @param entries The entry storage.
+ * @param entry_count The number of entries, which must be a power of 2.
+ *      The index holds up to 3/4 of entry_count topics.
+ * @param arena The storage for topic strings.
+ * @param arena_size The size of arena in bytes.
+ * @return 0 or FBP_ERROR_PARAMETER_INVALID.
+ */
+int32_t topic_index_initialize(struct topic_index_s * self,
+                               struct topic_index_entry_s * entries, uint32_t entry_count,
+                               char * arena, uint32_t arena_size);
+
+/**
+ * @brief Add a topic or update its value.
+ *
+ * @param self The instance.
+ * @param topic The full topic string, which is copied into the arena.
+ * @param value The value to associate with topic.
+ * @return 0 or FBP_ERROR_FULL.
+ */
+int32_t topic_index_add(struct topic_index_s * self, const char * topic, void * value);
+
+/**
+ * @brief Find a topic.
+ *
+ * @param self The instance.
+ * @param topic The full topic string.
+ * @return The value for topic or NULL if not found.
+ */
+void * topic_index_find(struct topic_index_s * self, const char * topic);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_TOPIC_INDEX_H__ */
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Hierarchical time synchronization across board chains.
+ *
+ * Each board disciplines its time from exactly one upstream port.
+ * It selects the client port whose peer has the lowest stratum, the
+ * number of hops to the time root, and serves the disciplined time
+ * on its server ports at its own stratum + 1.
+ *
+ * Each two-way exchange yields an offset and a round-trip delay.
+ * A minimum-delay filter over the last TSYNC_WINDOW exchanges, gated
+ * by the long-term minimum delay, rejects samples inflated by queueing
+ * and task scheduling.  The selected samples then steer the offset,
+ * and the drift is measured over a baseline of several seconds.  Each
+ * hop therefore passes on a smooth time instead of compounding the
+ * raw jitter.
+ *
+ * All times are fitterbap 64-bit times, see fitterbap/time.h.
+ */
+
+#ifndef APP_STM32G4_TSYNC_H__
+#define APP_STM32G4_TSYNC_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The number of comm ports, which must match UART_COUNT, see tsync.c.
+#define TSYNC_PORT_COUNT (5)
+
+/// The number of exchanges for the minimum-delay filter.
+#define TSYNC_WINDOW (8)
+
+/// The maximum stratum, which limits the chain depth.
+#define TSYNC_STRATUM_MAX (15)
+
+/// The stratum for a port or board without synchronized time.
+#define TSYNC_STRATUM_NONE (0xff)
+
+/// The port value for no upstream time source.
+#define TSYNC_PORT_NONE (0xff)
+
+/// A single two-way exchange, treat as opaque.
+struct tsync_sample_s {
+    int64_t local;      ///< The local time at the exchange midpoint.
+    int64_t offset;     ///< The upstream time - local time.
+    int64_t delay;      ///< The round-trip delay excluding upstream processing.
+};
+
+/// The time sync instance, treat as opaque.
+struct tsync_s {
+    uint8_t root;                               ///< 1 if this board is the time root.
+    uint8_t stratum;                            ///< The local stratum.
+    uint8_t port;                               ///< The upstream port.
+    uint8_t client_mask;                        ///< The connected client ports, bit mask.
+    uint8_t port_stratum[TSYNC_PORT_COUNT];     ///< The peer stratum for each port.
+    uint8_t state;                              ///< 0 free running, 1 holdover, 2 locked.
+    uint8_t window_idx;
+    uint8_t window_count;
+    struct tsync_sample_s window[TSYNC_WINDOW];
+    int64_t delay_min;                          ///< The slowly aging minimum delay.
+    int64_t selected_local;                     ///< The last selected sample.
+    int64_t ref_local;                          ///< The offset model anchor.
+    int64_t ref_offset;
+    int64_t drift_local;                        ///< The drift baseline start.
+    int64_t drift_offset;
+    int64_t drift;                              ///< The offset change per local time, Q30.
+};
+
+/**
+ * @brief Initialize a time sync instance.
+ *
+ * @param self The instance to initialize.
+ * @param root 1 if this board provides the reference time at
+ *      stratum 0, otherwise 0 to follow the best client port.
+ */
+void tsync_initialize(struct tsync_s * self, int root);
+
+/**
+ * @brief Update a port's peer.
+ *
+ * @param self The instance.
+ * @param port The port index, 0 to TSYNC_PORT_COUNT - 1.
+ * @param client 1 if the port is a client, which may provide the
+ *      upstream time, or 0 for a server port.
+ * @param stratum The peer's advertised stratum or TSYNC_STRATUM_NONE,
+ *      including when the link disconnects.
+ * @return 1 if the upstream port or local stratum changed, otherwise 0.
+ */
+int32_t tsync_port_set(struct tsync_s * self, uint8_t port, int client, uint8_t stratum);
+
+/**
+ * @brief Process a completed two-way exchange.
+ *
+ * @param self The instance.
+ * @param port The port that performed the exchange.
+ * @param t1 The local time when the request was sent.
+ * @param t2 The upstream time when the request was received.
+ * @param t3 The upstream time when the response was sent.
+ * @param t4 The local time when the response was received.
+ * @return 0, or FBP_ERROR_UNAVAILABLE if port is not the upstream port.
+ *
+ * Use receive times captured in the UART ISR, see uart_recv_fn, for
+ * t2 and t4.
+ */
+int32_t tsync_update(struct tsync_s * self, uint8_t port,
+                     int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+/**
+ * @brief Convert local time to disciplined time.
+ *
+ * @param self The instance.
+ * @param local The local time, usually fbp_time_rel().
+ * @return The disciplined time to use locally and serve downstream.
+ */
+int64_t tsync_time(struct tsync_s * self, int64_t local);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_TSYNC_H__ */
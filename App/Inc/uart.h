@@ -0,0 +1,176 @@
+/*
+ * Copyright 2020-2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APP_STM32G4_UART_H__
+#define APP_STM32G4_UART_H__
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fitterbap/event_manager.h"
+#include "fitterbap/os/mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The number of UART instances, see uart_get().
+#define UART_COUNT (5)
+
+/*
+ * The supported baud rates.  These are plain literals so that app_comms
+ * can also place them in the PubSub metadata JSON.
+ */
+#define UART_BAUDRATE_DEFAULT 3000000
+#define UART_BAUDRATE_MIN 9600
+#define UART_BAUDRATE_MAX 10625000
+
+/// The opaque UART instance.
+struct uart_s;
+
+/**
+ * @brief The UART statistics, see uart_stats().
+ *
+ * All fields are uint32_t.  app_comms publishes them in this order.
+ */
+struct uart_stats_s {
+    uint32_t rx_bytes;          ///< Total bytes received, modulo 2**32.
+    uint32_t tx_bytes;          ///< Total bytes transmitted, modulo 2**32.
+    uint32_t rx_lap;            ///< RX buffer overflows, where the DMA overwrote unread data.
+    uint32_t rx_overrun;        ///< USART overrun errors (ORE).
+    uint32_t rx_framing;        ///< USART framing errors (FE).
+    uint32_t rx_noise;          ///< USART noise errors (NE).
+    uint32_t dma_error;         ///< RX and TX DMA transfer errors.
+    uint32_t rx_backlog_max;    ///< Maximum unprocessed RX data, in bytes.
+    uint32_t tx_fill_max;       ///< Maximum TX buffer fill, in bytes.
+    uint32_t rx_latency_max;    ///< Maximum delay from the RX ISR to uart_recv_fn, in microseconds.
+};
+
+/**
+ * @brief The function called when the UART receives data.
+ *
+ * @param user_data The arbitrary data.
+ * @param buffer The received data.
+ * @param buffer_size The size of buffer in bytes.
+ * @param rx_counter The fitterbap_support_counter() value captured in the
+ *      receive ISR when the last byte of buffer arrived.  Unlike the
+ *      time of this call, it does not include task scheduling delay.
+ */
+typedef void (*uart_recv_fn)(void *user_data, uint8_t *buffer, uint32_t buffer_size, uint64_t rx_counter);
+
+/**
+ * @brief Get a UART instance.
+ *
+ * @param index The instance index, 0 to UART_COUNT - 1.  Index 0 is
+ *      USART1, index 1 is USART2, and so on.
+ * @return The instance or NULL if index is not valid.
+ */
+struct uart_s * uart_get(uint32_t index);
+
+/**
+ * @brief Initialize the UART and thread.
+ *
+ * @param self The UART instance.
+ */
+void uart_initialize(struct uart_s * self);
+
+/**
+ * @brief Populate the event manager API.
+ *
+ * @param self The UART instance.
+ * @param api[out] The API instance populated with the event manager instance
+ *      and callbacks running on the UART thread.
+ *
+ * All events for processing on this thread MUST be posted to this
+ * event manager.
+ */
+void uart_evm_api(struct uart_s * self, struct fbp_evm_api_s * api);
+
+/**
+ * @brief Set the function called when the UART receives data.
+ *
+ * @param self The UART instance.
+ * @param recv_fn The function to call with received data.
+ * @param recv_user_data The arbitrary data for recv_fn.
+ */
+void uart_recv_register(struct uart_s * self, uart_recv_fn recv_fn, void * recv_user_data);
+
+/**
+ * @brief Transmit data out the UART.
+ *
+ * @param self The UART instance.
+ * @param buffer The data to transmit.
+ * @param buffer_size The size of buffer in bytes.
+ * @return 0 or FBP_ERROR_NOT_ENOUGH_MEMORY.
+ */
+int32_t uart_send(struct uart_s * self, uint8_t const *buffer, uint32_t buffer_size);
+
+/**
+ * @brief Get the amount of space available in the transmit buffer.
+ *
+ * @param self The UART instance.
+ * @return The available transmit buffer, in bytes.
+ *
+ * Calling this function and respecting buffer_size can
+ * ensure that the subsequent call to uart_send succeeds.
+ */
+uint32_t uart_send_available(struct uart_s * self);
+
+/**
+ * @brief Get the mutex for accessing this UART thread.
+ *
+ * @param self The UART instance.
+ * @param mutex[out] The mutex.
+ */
+void uart_mutex(struct uart_s * self, fbp_os_mutex_t * mutex);
+
+/**
+ * @brief Change the baud rate.
+ *
+ * @param self The UART instance.
+ * @param baudrate The new baud rate, UART_BAUDRATE_MIN to UART_BAUDRATE_MAX.
+ * @return 0 or FBP_ERROR_PARAMETER_INVALID.
+ *
+ * The switch is coordinated so that the data link session survives.
+ * The UART waits a short delay, holds off new TX data, waits for
+ * the transmitter to drain and then reprograms the peripheral.  The
+ * delay gives a request sent to the peer over this link time to
+ * arrive at the old rate.  Request the peer first, then the local
+ * port.  The data link retransmits frames lost in between.
+ */
+int32_t uart_baudrate_set(struct uart_s * self, uint32_t baudrate);
+
+/**
+ * @brief Get the active baud rate.
+ *
+ * @param self The UART instance.
+ * @return The baud rate.
+ */
+uint32_t uart_baudrate_get(struct uart_s * self);
+
+/**
+ * @brief Get the UART statistics.
+ *
+ * @param self The UART instance.
+ * @param stats[out] The statistics, counted since uart_initialize().
+ */
+void uart_stats(struct uart_s * self, struct uart_stats_s * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* APP_STM32G4_UART_H__ */
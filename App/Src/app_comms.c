@@ -15,7 +15,10 @@
  */
 
 #include "app_comms.h"
+#include "app_os.h"
 #include "log_handler.h"
+#include "topic_index.h"
+#include "fitterbap/comm/data_link.h"
 #include "fitterbap/comm/stack.h"
 #include "fitterbap/comm/timesync.h"
 #include "fitterbap/assert.h"
@@ -23,17 +26,14 @@
 #include "fitterbap/ec.h"
 #include "fitterbap/log.h"
 #include "fitterbap/time.h"
-#include "uart1.h"
-#include "uart2.h"
-#include "uart3.h"
-#include "uart4.h"
-#include "uart5.h"
+#include "uart.h"
 #include "cmsis_os.h"
 #include "main.h"
 #include "stm32g4xx_ll_gpio.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include <string.h>
 
 
 #define TIMEOUT_DEFAULT_MS (1000)
@@ -42,35 +42,89 @@
 #define PUBSUB_TASK_PRIORITY ((osPriority_t) osPriorityNormal)
 #define PUBSUB_SERVICE_TIME_MAX_MS (500)
 #define DATA_DYNAMIC_BUFFER_SIZE (512)
+#define STATS_INTERVAL_MS (1000)
+#define BAUD_REVERT_MS 1000       // restore the old baud rate without RX frames for this long, in BAUD_META
+#define STR_(x) #x
+#define STR(x) STR_(x)
+
+/// The baud rate switch for one port, see on_baud().
+struct baud_s {
+    struct uart_s * uart;
+    struct fbp_stack_s * stack;
+    struct fbp_evm_api_s evm_api;
+    char topic[8];              // "cN/baud"
+    uint32_t baudrate;          // the new baud rate while verifying, 0 when idle
+    uint32_t baudrate_prev;     // restored when no frames arrive at baudrate
+    uint8_t switched;           // the UART runs at baudrate
+    uint64_t rx_frames;         // fbp_dl data frames received at the switch
+    int32_t event_id;
+};
 
 static fbp_os_mutex_t pubsub_mutex_;
 struct fbp_pubsub_s * pubsub = NULL;
 static TaskHandle_t pubsub_task_;
+APP_TASK_MEMORY(pubsub, PUBSUB_TASK_STACK);
 static struct fbp_ts_s * timesync_ = NULL;
 
 enum pubsub_events_e {
     PUBSUB_EV_RECV = (1 << 0),
+    PUBSUB_EV_COALESCE = (1 << 1),
 };
 
-struct stack_fn_s {
-    void (*initialize)();
-    void (*evm_api)(struct fbp_evm_api_s * api);
-    void (*recv_register)(uart1_recv_fn recv_fn, void * recv_user_data);
-    int32_t (*send)(uint8_t const *buffer, uint32_t buffer_size);
-    uint32_t (*send_available)();
-    void (*mutex)(fbp_os_mutex_t * mutex);
+// Power of 2 at or above APP_TOPIC_COALESCE_MAX / 0.75
+#define COALESCE_INDEX_SIZE (32)
+static struct topic_index_s coalesce_index_;
+static struct topic_index_entry_s coalesce_entries_[COALESCE_INDEX_SIZE];
+static char coalesce_arena_[APP_TOPIC_COALESCE_MAX * FBP_PUBSUB_TOPIC_LENGTH_MAX];
+static struct app_topic_s * coalesce_list_ = NULL;
+
+/// A subscription from app_subscribe_throttled(), only accessed by the pubsub task.
+struct throttle_s {
+    fbp_pubsub_subscribe_fn cbk_fn;
+    void * cbk_user_data;
+    uint32_t interval;              // in ticks
 };
 
-// function pointer table to uart instances
-static const struct stack_fn_s stack_fn[5] = {
-    {uart1_initialize, uart1_evm_api, uart1_recv_register, uart1_send, uart1_send_available, uart1_mutex},
-    {uart2_initialize, uart2_evm_api, uart2_recv_register, uart2_send, uart2_send_available, uart2_mutex},
-    {uart3_initialize, uart3_evm_api, uart3_recv_register, uart3_send, uart3_send_available, uart3_mutex},
-    {uart4_initialize, uart4_evm_api, uart4_recv_register, uart4_send, uart4_send_available, uart4_mutex},
-    {uart5_initialize, uart5_evm_api, uart5_recv_register, uart5_send, uart5_send_available, uart5_mutex},
+/// The per-topic state for a throttle_s, free when owner is NULL.
+struct throttle_slot_s {
+    struct throttle_s * owner;
+    uint32_t last;                  // the tick count at the last delivery
+    uint8_t pending;
+    struct fbp_union_s value;       // the held value when pending
+    char topic[FBP_PUBSUB_TOPIC_LENGTH_MAX];
 };
 
-struct fbp_stack_s * stacks[5] = {NULL, NULL, NULL, NULL, NULL};
+static struct throttle_s throttles_[APP_SUBSCRIBE_THROTTLE_MAX];
+static uint32_t throttle_count_ = 0;
+static struct throttle_slot_s throttle_slots_[APP_SUBSCRIBE_THROTTLE_SLOTS];
+
+struct fbp_stack_s * stacks[UART_COUNT];
+static struct baud_s bauds_[UART_COUNT];
+static struct uart_stats_s stats_[UART_COUNT];
+static uint32_t stats_time_ = 0;
+
+/// The uart_stats_s fields published to "cN/stats/{name}", in order.
+static const char * const STATS_NAMES[] = {
+    "rx_bytes",
+    "tx_bytes",
+    "rx_lap",
+    "rx_overrun",
+    "rx_framing",
+    "rx_noise",
+    "dma_error",
+    "rx_backlog_max",
+    "tx_fill_max",
+    "rx_latency_max",
+};
+FBP_STATIC_ASSERT(sizeof(struct uart_stats_s) == FBP_ARRAY_SIZE(STATS_NAMES) * sizeof(uint32_t), stats_names);
+
+static const char STATS_META[] =
+    "{"
+        "\"dtype\": \"u32\","
+        "\"brief\": \"UART statistic.\","
+        "\"default\": 0,"
+        "\"flags\": [\"ro\"]"
+    "}";
 
 int64_t fbp_time_utc() {
     return fbp_ts_time(timesync_);
@@ -79,7 +133,7 @@ int64_t fbp_time_utc() {
 static char app_prefix() {
     // Note that this value is also available as "_/topic/prefix"
     static uint8_t ch = 0;
-    if (~ch) {
+    if (!ch) {
         ch = 'a'
              + (LL_GPIO_IsInputPinSet(ID0_GPIO_Port, ID0_Pin) ? 1 : 0)
              + (LL_GPIO_IsInputPinSet(ID1_GPIO_Port, ID1_Pin) ? 2 : 0)
@@ -108,12 +162,135 @@ int32_t app_unsubscribe(const char * topic, fbp_pubsub_subscribe_fn cbk_fn, void
     return fbp_pubsub_unsubscribe(pubsub, topic_ex, cbk_fn, cbk_user_data);
 }
 
+static inline int coalesce_supported(const struct fbp_union_s * value) {
+    // Pointer types reference caller memory that may change before the flush.
+    return (value->type != FBP_UNION_STR) && (value->type != FBP_UNION_JSON) && (value->type != FBP_UNION_BIN);
+}
+
+static int32_t coalesce_publish(struct app_topic_s * h, const struct fbp_union_s * value,
+                                fbp_pubsub_subscribe_fn src_fn, void * src_user_data) {
+    taskENTER_CRITICAL();
+    uint8_t pending = h->pending;
+    h->value = *value;
+    h->src_fn = src_fn;
+    h->src_user_data = src_user_data;
+    h->pending = 1;
+    taskEXIT_CRITICAL();
+    if (!pending && pubsub_task_) {
+        xTaskNotify(pubsub_task_, PUBSUB_EV_COALESCE, eSetBits);
+    }
+    return 0;
+}
+
+static void coalesce_flush() {
+    struct fbp_union_s value;
+    fbp_pubsub_subscribe_fn src_fn;
+    void * src_user_data;
+    for (struct app_topic_s * h = coalesce_list_; h; h = h->next) {
+        if (!h->pending) {
+            continue;
+        }
+        taskENTER_CRITICAL();
+        value = h->value;
+        src_fn = h->src_fn;
+        src_user_data = h->src_user_data;
+        h->pending = 0;
+        taskEXIT_CRITICAL();
+        fbp_pubsub_publish(pubsub, h->topic, &value, src_fn, src_user_data);
+    }
+}
+
 int32_t app_publish(const char * topic, const struct fbp_union_s * value,
                     fbp_pubsub_subscribe_fn src_fn, void * src_user_data) {
     TOPIC_EXTEND();
+    if (coalesce_list_ && coalesce_supported(value)) {
+        struct app_topic_s * h = topic_index_find(&coalesce_index_, topic_ex);
+        if (h) {
+            return coalesce_publish(h, value, src_fn, src_user_data);
+        }
+    }
     return fbp_pubsub_publish(pubsub, topic_ex, value, src_fn, src_user_data);
 }
 
+static uint8_t throttle_deliver(struct throttle_slot_s * slot, const char * topic, const struct fbp_union_s * value) {
+    slot->pending = 0;
+    slot->last = xTaskGetTickCount();
+    return slot->owner->cbk_fn(slot->owner->cbk_user_data, topic, value);
+}
+
+static inline int throttle_slot_expired(struct throttle_slot_s * slot, uint32_t now) {
+    return (now - slot->last) >= slot->owner->interval;
+}
+
+static uint8_t on_throttle(void * user_data, const char * topic, const struct fbp_union_s * value) {
+    struct throttle_s * t = (struct throttle_s *) user_data;
+    if (!coalesce_supported(value)) {
+        return t->cbk_fn(t->cbk_user_data, topic, value);
+    }
+    uint32_t now = xTaskGetTickCount();
+    struct throttle_slot_s * slot_free = NULL;
+    for (uint32_t i = 0; i < APP_SUBSCRIBE_THROTTLE_SLOTS; ++i) {
+        struct throttle_slot_s * slot = &throttle_slots_[i];
+        if (!slot->owner) {
+            slot_free = slot_free ? slot_free : slot;
+        } else if ((slot->owner == t) && (0 == strcmp(slot->topic, topic))) {
+            if (throttle_slot_expired(slot, now)) {
+                return throttle_deliver(slot, topic, value);
+            }
+            slot->value = *value;
+            slot->pending = 1;
+            return 0;
+        } else if (!slot->pending && throttle_slot_expired(slot, now)) {
+            slot_free = slot_free ? slot_free : slot;  // idle, reclaim
+        }
+    }
+    if (!slot_free) {
+        // More active topics than slots: deliver without throttling.
+        return t->cbk_fn(t->cbk_user_data, topic, value);
+    }
+    slot_free->owner = t;
+    fbp_cstr_copy(slot_free->topic, topic, sizeof(slot_free->topic));
+    return throttle_deliver(slot_free, topic, value);
+}
+
+/**
+ * @brief Deliver held throttled values whose interval expired.
+ *
+ * @return The ticks until the next held value is due, at most timeout.
+ */
+static uint32_t throttle_process(uint32_t timeout) {
+    uint32_t now = xTaskGetTickCount();
+    for (uint32_t i = 0; i < APP_SUBSCRIBE_THROTTLE_SLOTS; ++i) {
+        struct throttle_slot_s * slot = &throttle_slots_[i];
+        if (!slot->owner || !slot->pending) {
+            continue;
+        }
+        uint32_t elapsed = now - slot->last;
+        if (elapsed >= slot->owner->interval) {
+            throttle_deliver(slot, slot->topic, &slot->value);
+        } else if ((slot->owner->interval - elapsed) < timeout) {
+            timeout = slot->owner->interval - elapsed;
+        }
+    }
+    return timeout;
+}
+
+int32_t app_subscribe_throttled(const char * topic, uint8_t flags, uint32_t interval_ms,
+                                fbp_pubsub_subscribe_fn cbk_fn, void * cbk_user_data) {
+    if (!interval_ms) {
+        return app_subscribe(topic, flags, cbk_fn, cbk_user_data);
+    }
+    if (throttle_count_ >= APP_SUBSCRIBE_THROTTLE_MAX) {
+        return FBP_ERROR_FULL;
+    }
+    struct throttle_s * t = &throttles_[throttle_count_];
+    t->cbk_fn = cbk_fn;
+    t->cbk_user_data = cbk_user_data;
+    t->interval = pdMS_TO_TICKS(interval_ms);
+    ++throttle_count_;
+    return app_subscribe(topic, flags, on_throttle, t);
+}
+
 int32_t app_meta(const char * topic, const char * meta_json) {
     TOPIC_EXTEND();
     return fbp_pubsub_meta(pubsub, topic_ex, meta_json);
@@ -124,14 +301,126 @@ int32_t app_query(const char * topic, struct fbp_union_s * value) {
     return fbp_pubsub_query(pubsub, topic_ex, value);
 }
 
+int32_t app_topic_resolve(struct app_topic_s * handle, const char * topic) {
+    if (strlen(topic) > (FBP_PUBSUB_TOPIC_LENGTH_MAX - 3)) {
+        return FBP_ERROR_PARAMETER_INVALID;
+    }
+    TOPIC_EXTEND();
+    if (handle->topic[0]) {
+        // Already resolved: keep the flags and the coalesce_list_ link.
+        return strcmp(handle->topic, topic_ex) ? FBP_ERROR_PARAMETER_INVALID : 0;
+    }
+    memcpy(handle->topic, topic_ex, sizeof(topic_ex));
+    handle->flags = 0;
+    handle->pending = 0;
+    handle->next = NULL;
+    return 0;
+}
+
+int32_t app_topic_flags_set(struct app_topic_s * handle, uint8_t flags) {
+    if ((flags & APP_TOPIC_FLAG_COALESCE) && !(handle->flags & APP_TOPIC_FLAG_COALESCE)) {
+        if (!coalesce_index_.entries) {
+            topic_index_initialize(&coalesce_index_, coalesce_entries_, COALESCE_INDEX_SIZE,
+                                   coalesce_arena_, sizeof(coalesce_arena_));
+        }
+        if ((coalesce_index_.count >= APP_TOPIC_COALESCE_MAX)
+                || topic_index_add(&coalesce_index_, handle->topic, handle)) {
+            return FBP_ERROR_FULL;
+        }
+        taskENTER_CRITICAL();
+        handle->next = coalesce_list_;
+        coalesce_list_ = handle;
+        taskEXIT_CRITICAL();
+    }
+    handle->flags |= flags;
+    return 0;
+}
+
+int32_t app_subscribe_h(const struct app_topic_s * topic, uint8_t flags,
+                        fbp_pubsub_subscribe_fn cbk_fn, void * cbk_user_data) {
+    return fbp_pubsub_subscribe(pubsub, topic->topic, flags, cbk_fn, cbk_user_data);
+}
+
+int32_t app_publish_h(struct app_topic_s * topic, const struct fbp_union_s * value,
+                      fbp_pubsub_subscribe_fn src_fn, void * src_user_data) {
+    if ((topic->flags & APP_TOPIC_FLAG_COALESCE) && coalesce_supported(value)) {
+        return coalesce_publish(topic, value, src_fn, src_user_data);
+    }
+    return fbp_pubsub_publish(pubsub, topic->topic, value, src_fn, src_user_data);
+}
+
+int32_t app_query_h(const struct app_topic_s * topic, struct fbp_union_s * value) {
+    return fbp_pubsub_query(pubsub, topic->topic, value);
+}
+
+static const char BAUD_META[] =
+    "{"
+        "\"dtype\": \"u32\","
+        "\"brief\": \"UART baud rate.  To change both ends of a link, write the "
+            "new rate to the peer's cN/baud first, then to this one.  Each end "
+            "restores the old rate and publishes it here when it receives no data link "
+            "frame within " STR(BAUD_REVERT_MS) " ms after switching.\","
+        "\"default\": " STR(UART_BAUDRATE_DEFAULT) ","
+        "\"range\": [" STR(UART_BAUDRATE_MIN) ", " STR(UART_BAUDRATE_MAX) "]"
+    "}";
+
+static void stats_topic(char * topic, uint32_t port, uint32_t idx) {
+    char * t = topic;
+    *t++ = 'c';
+    *t++ = '1' + port;
+    fbp_cstr_copy(t, "/stats/", FBP_PUBSUB_TOPIC_LENGTH_MAX - 2);
+    fbp_cstr_copy(t + 7, STATS_NAMES[idx], FBP_PUBSUB_TOPIC_LENGTH_MAX - 9);
+}
+
+static void stats_meta() {
+    char topic[FBP_PUBSUB_TOPIC_LENGTH_MAX];
+    for (uint32_t port = 0; port < UART_COUNT; ++port) {
+        for (uint32_t idx = 0; idx < FBP_ARRAY_SIZE(STATS_NAMES); ++idx) {
+            stats_topic(topic, port, idx);
+            app_meta(topic, STATS_META);
+        }
+    }
+}
+
+/**
+ * @brief Publish the UART statistics that changed since the last call.
+ */
+static void stats_publish() {
+    char topic[FBP_PUBSUB_TOPIC_LENGTH_MAX];
+    struct uart_stats_s stats;
+    for (uint32_t port = 0; port < UART_COUNT; ++port) {
+        uart_stats(uart_get(port), &stats);
+        uint32_t * v_new = (uint32_t *) &stats;
+        uint32_t * v_old = (uint32_t *) &stats_[port];
+        for (uint32_t idx = 0; idx < FBP_ARRAY_SIZE(STATS_NAMES); ++idx) {
+            if (v_new[idx] != v_old[idx]) {
+                v_old[idx] = v_new[idx];
+                stats_topic(topic, port, idx);
+                app_publish(topic, &fbp_union_u32_r(v_new[idx]), NULL, NULL);
+            }
+        }
+    }
+}
+
 static void pubsub_task(void *argument) {
     (void) argument;
     uint32_t notify;
+    uint32_t now;
+    uint32_t timeout = PUBSUB_SERVICE_TIME_MAX_MS;
     while (1) {
         notify = 0;
-        if (pdTRUE == xTaskNotifyWait(0, 0xffffffff, &notify, PUBSUB_SERVICE_TIME_MAX_MS)) {
+        if (pdTRUE == xTaskNotifyWait(0, 0xffffffff, &notify, timeout)) {
+            if (notify & PUBSUB_EV_COALESCE) {
+                coalesce_flush();
+            }
             fbp_pubsub_process(pubsub);
         }
+        timeout = throttle_process(PUBSUB_SERVICE_TIME_MAX_MS);
+        now = xTaskGetTickCount();
+        if (stacks[UART_COUNT - 1] && ((now - stats_time_) >= pdMS_TO_TICKS(STATS_INTERVAL_MS))) {
+            stats_time_ = now;
+            stats_publish();
+        }
         // todo watchdog pet, regardless of data send/receive
     }
 }
@@ -147,48 +436,139 @@ void app_pubsub_initialize() {
     if (pubsub) {
         return;
     }
-    pubsub_mutex_ = xSemaphoreCreateMutex();
-    FBP_ASSERT_ALLOC(pubsub_mutex_);
-
     char pubsub_topic_prefix[2];
     pubsub_topic_prefix[0] = app_prefix();
     pubsub_topic_prefix[1] = 0;
     pubsub = fbp_pubsub_initialize(pubsub_topic_prefix, DATA_DYNAMIC_BUFFER_SIZE);
     FBP_ASSERT_ALLOC(pubsub);
 
-    if (pdTRUE != xTaskCreate(
+    if (pdTRUE != app_task_create(
             pubsub_task,            /* pvTaskCode */
             "pubsub",               /* pcName */
             PUBSUB_TASK_STACK,      /* usStackDepth in 32-bit words */
             NULL,                   /* pvParameters */
             PUBSUB_TASK_PRIORITY,   /* uxPriority */
-            &pubsub_task_)) {
+            &pubsub_task_,          /* pxCreatedTask */
+            APP_TASK_STACK(pubsub),
+            APP_TASK_TCB(pubsub))) {
         FBP_FATAL("pubsub task");
     }
 
-    pubsub_mutex_ = fbp_os_mutex_alloc();
-    if (!pubsub_mutex_) {
-        FBP_FATAL("mutex");
-    }
+    pubsub_mutex_ = app_mutex_alloc();
     fbp_pubsub_register_mutex(pubsub, pubsub_mutex_);
     fbp_pubsub_register_on_publish(pubsub, on_publish, NULL);
 }
 
+/*
+ * fbp_dl builds each frame in its own buffer and then calls this
+ * function, so uart_send() copies the frame once into the TX ring.
+ * Building frames in place would need a reserve/commit hook in
+ * fbp_dl_ll_s, which belongs to the fitterbap submodule.
+ */
 static void parent_phy_send(void * user_data, uint8_t const * buffer, uint32_t buffer_size) {
-    struct stack_fn_s * stack = (struct stack_fn_s *) user_data;
-    stack->send(buffer, buffer_size);
+    struct uart_s * uart = (struct uart_s *) user_data;
+    uart_send(uart, buffer, buffer_size);
 }
 
 static uint32_t parent_phy_send_available(void * user_data) {
-    struct stack_fn_s * stack = (struct stack_fn_s *) user_data;
-    return stack->send_available();
+    struct uart_s * uart = (struct uart_s *) user_data;
+    return uart_send_available(uart);
 }
 
-static void on_uart_recv_fn(void *user_data, uint8_t *buffer, uint32_t buffer_size) {
+static void on_uart_recv_fn(void *user_data, uint8_t *buffer, uint32_t buffer_size, uint64_t rx_counter) {
     struct fbp_stack_s * stack = (struct fbp_stack_s *) user_data;
+    (void) rx_counter;  // fbp_dl_ll_recv() does not yet accept a receive time
     fbp_dl_ll_recv(stack->dl, buffer, buffer_size);
 }
 
+static uint8_t on_baud(void * user_data, const char * topic, const struct fbp_union_s * value);
+
+static uint64_t baud_rx_frames(struct baud_s * self) {
+    struct fbp_dl_status_s status;
+    if (fbp_dl_status_get(self->stack->dl, &status)) {
+        return 0;
+    }
+    return status.rx.data_frames;
+}
+
+/**
+ * @brief Revert a baud rate switch that the peer did not follow.
+ *
+ * @param user_data The baud_s instance.
+ * @param event_id The event manager event id, unused.
+ *
+ * Runs on the UART task from the event manager.  Waits for the UART
+ * to apply the switch, then for BAUD_REVERT_MS, and restores the
+ * previous baud rate when no fbp_dl data frame arrived meanwhile.
+ */
+static void on_baud_verify(void * user_data, int32_t event_id) {
+    (void) event_id;
+    struct baud_s * self = (struct baud_s *) user_data;
+    int64_t now = self->evm_api.timestamp(self->evm_api.evm);
+    if (!self->baudrate) {
+        return;
+    } else if (!self->switched) {
+        if (uart_baudrate_get(self->uart) == self->baudrate) {
+            self->switched = 1;
+            self->rx_frames = baud_rx_frames(self);
+            now += BAUD_REVERT_MS * FBP_TIME_MILLISECOND;
+        } else {
+            now += FBP_TIME_MILLISECOND;  // switch still pending
+        }
+        self->event_id = self->evm_api.schedule(self->evm_api.evm, now, on_baud_verify, self);
+        return;
+    }
+    uint32_t baudrate = self->baudrate;
+    self->baudrate = 0;
+    self->event_id = 0;
+    if (baud_rx_frames(self) == self->rx_frames) {
+        FBP_LOGW("%s: no frames at %lu, revert to %lu", self->topic,
+                 (unsigned long) baudrate, (unsigned long) self->baudrate_prev);
+        uart_baudrate_set(self->uart, self->baudrate_prev);
+        app_publish(self->topic, &fbp_union_u32_r(self->baudrate_prev), on_baud, self);
+    }
+}
+
+static uint8_t on_baud(void * user_data, const char * topic, const struct fbp_union_s * value) {
+    (void) topic;
+    struct baud_s * self = (struct baud_s *) user_data;
+    struct fbp_union_s v = *value;
+    uint32_t baudrate_prev = uart_baudrate_get(self->uart);
+    if (fbp_union_as_type(&v, FBP_UNION_U32) || uart_baudrate_set(self->uart, v.value.u32)) {
+        FBP_LOGW("on_baud: invalid value");
+        return FBP_ERROR_PARAMETER_INVALID;
+    }
+    if (self->event_id) {
+        self->evm_api.cancel(self->evm_api.evm, self->event_id);
+        self->event_id = 0;
+    }
+    if (self->baudrate) {
+        baudrate_prev = self->baudrate_prev;  // the last rate known to work
+    }
+    self->baudrate = 0;
+    if (v.value.u32 != baudrate_prev) {
+        self->baudrate_prev = baudrate_prev;
+        self->switched = 0;
+        self->baudrate = v.value.u32;
+        int64_t now = self->evm_api.timestamp(self->evm_api.evm);
+        self->event_id = self->evm_api.schedule(self->evm_api.evm, now + FBP_TIME_MILLISECOND,
+                                                on_baud_verify, self);
+    }
+    return 0;
+}
+
+static void baud_initialize(struct uart_s * uart, uint32_t uart_offset) {
+    struct baud_s * self = &bauds_[uart_offset];
+    self->uart = uart;
+    self->stack = stacks[uart_offset];
+    uart_evm_api(uart, &self->evm_api);
+    fbp_cstr_copy(self->topic, "c0/baud", sizeof(self->topic));
+    self->topic[1] = '1' + uart_offset;
+    app_meta(self->topic, BAUD_META);
+    app_subscribe(self->topic, 0, on_baud, self);
+    app_publish(self->topic, &fbp_union_u32_r(uart_baudrate_get(uart)), on_baud, self);
+}
+
 static int32_t parent_link_initialize(struct fbp_pubsub_s * pubsub) {
     char subtopic[] = "c0/";
     struct fbp_evm_api_s evm_api;
@@ -205,14 +585,14 @@ static int32_t parent_link_initialize(struct fbp_pubsub_s * pubsub) {
             .tx_link_size = 64,
     };
 
-    for (int uart_offset = 0; uart_offset < 5; ++uart_offset) {
-        const struct stack_fn_s * fn = &stack_fn[uart_offset];
-        fn->initialize();
-        fn->evm_api(&evm_api);
-        fn->mutex(&mutex);
+    for (int uart_offset = 0; uart_offset < UART_COUNT; ++uart_offset) {
+        struct uart_s * uart = uart_get(uart_offset);
+        uart_initialize(uart);
+        uart_evm_api(uart, &evm_api);
+        uart_mutex(uart, &mutex);
 
         struct fbp_dl_ll_s ll = {
-                .user_data = (void *) fn,
+                .user_data = uart,
                 .send = parent_phy_send,
                 .send_available = parent_phy_send_available,
         };
@@ -228,7 +608,8 @@ static int32_t parent_link_initialize(struct fbp_pubsub_s * pubsub) {
             FBP_FATAL("host_link_stack");
         }
         fbp_stack_mutex_set(stacks[uart_offset], mutex);
-        fn->recv_register(on_uart_recv_fn, stacks[uart_offset]);
+        uart_recv_register(uart, on_uart_recv_fn, stacks[uart_offset]);
+        baud_initialize(uart, uart_offset);
 
         // Forward log messages from servers to local logger.
         if (mode == FBP_PORT0_MODE_SERVER) {
@@ -238,6 +619,7 @@ static int32_t parent_link_initialize(struct fbp_pubsub_s * pubsub) {
             fbp_logh_dispatch_register(NULL, fbp_logp_recv, stacks[uart_offset]->logp);
         }
     }
+    stats_meta();
     return 0;
 }
 
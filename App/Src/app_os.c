@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "app_os.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/log.h"
+#include "semphr.h"
+
+#if APP_STATIC_ALLOC && !configSUPPORT_STATIC_ALLOCATION
+#error "APP_STATIC_ALLOC requires configSUPPORT_STATIC_ALLOCATION"
+#endif
+
+#if APP_STATIC_ALLOC
+
+static uint64_t pool_[APP_POOL_SIZE / sizeof(uint64_t)];
+static uint32_t pool_used_ = 0;                 // in uint64_t
+static StaticSemaphore_t mutexes_[APP_MUTEX_MAX];
+static uint32_t mutex_count_ = 0;
+
+BaseType_t app_task_create(TaskFunction_t fn, const char * name, uint16_t stack_depth,
+                           void * parameters, UBaseType_t priority, TaskHandle_t * handle,
+                           StackType_t * stack, StaticTask_t * tcb) {
+    TaskHandle_t h = xTaskCreateStatic(fn, name, stack_depth, parameters, priority, stack, tcb);
+    if (handle) {
+        *handle = h;
+    }
+    return h ? pdTRUE : pdFALSE;
+}
+
+fbp_os_mutex_t app_mutex_alloc() {
+    // The fitterbap FreeRTOS mutex is the SemaphoreHandle_t.
+    taskENTER_CRITICAL();
+    StaticSemaphore_t * m = (mutex_count_ < APP_MUTEX_MAX) ? &mutexes_[mutex_count_++] : 0;
+    taskEXIT_CRITICAL();
+    if (!m) {
+        FBP_FATAL("APP_MUTEX_MAX exhausted");
+    }
+    return (fbp_os_mutex_t) xSemaphoreCreateMutexStatic(m);
+}
+
+void app_heap_check() {
+    uint32_t heap_free = (uint32_t) xPortGetFreeHeapSize();
+    if (heap_free < APP_STATIC_HEAP_MARGIN) {
+        FBP_LOGE("heap free %lu < margin %lu", (unsigned long) heap_free, (unsigned long) APP_STATIC_HEAP_MARGIN);
+        FBP_FATAL("APP_STATIC_HEAP_SIZE too small");
+    }
+}
+
+void * app_pool_alloc(uint32_t size_bytes) {
+    void * p = 0;
+    uint32_t sz = (size_bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    taskENTER_CRITICAL();
+    if (sz <= (FBP_ARRAY_SIZE(pool_) - pool_used_)) {
+        p = &pool_[pool_used_];
+        pool_used_ += sz;
+    }
+    taskEXIT_CRITICAL();
+    return p;
+}
+
+uint32_t app_pool_free() {
+    return (uint32_t) ((FBP_ARRAY_SIZE(pool_) - pool_used_) * sizeof(uint64_t));
+}
+
+#else
+
+BaseType_t app_task_create(TaskFunction_t fn, const char * name, uint16_t stack_depth,
+                           void * parameters, UBaseType_t priority, TaskHandle_t * handle,
+                           StackType_t * stack, StaticTask_t * tcb) {
+    (void) stack;
+    (void) tcb;
+    return xTaskCreate(fn, name, stack_depth, parameters, priority, handle);
+}
+
+fbp_os_mutex_t app_mutex_alloc() {
+    fbp_os_mutex_t m = fbp_os_mutex_alloc();
+    if (!m) {
+        FBP_FATAL("mutex");
+    }
+    return m;
+}
+
+void app_heap_check() {
+    // The whole heap is available, and sys/mem/heap reports its use.
+}
+
+void * app_pool_alloc(uint32_t size_bytes) {
+    (void) size_bytes;
+    return 0;
+}
+
+uint32_t app_pool_free() {
+    return 0;
+}
+
+#endif
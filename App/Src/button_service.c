@@ -22,6 +22,7 @@
 #include <stdbool.h>
 
 static const char TOPIC[] = "button/0";
+static struct app_topic_s topic_;
 static uint32_t button_value_ = 0;
 
 
@@ -36,6 +37,7 @@ static const char META[] =
 
 void button_service_initialize() {
     app_meta(TOPIC, META);
+    app_topic_resolve(&topic_, TOPIC);
 }
 
 void button_service_poll() {
@@ -43,7 +45,7 @@ void button_service_poll() {
     if (now != button_value_) {
         button_value_ = now;
         FBP_LOGI("on_button(%s)", button_value_ ? "on" : "off");
-        app_publish(TOPIC, &fbp_union_u8_r(now), NULL, NULL);
+        app_publish_h(&topic_, &fbp_union_u8_r(now), NULL, NULL);
     }
 }
 
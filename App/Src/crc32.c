@@ -0,0 +1,191 @@
+/*
+ * Copyright 2020-2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * CRC-32 using the STM32G4 CRC unit.
+ *
+ * The unit computes the IEEE 802.3 CRC-32 with the default 0x04C11DB7
+ * polynomial.  Bit reversal of the input and output produces the
+ * reflected CRC that fbp_crc32() computes.  Reversing the input by
+ * word processes a little-endian word in memory order, so aligned
+ * data is fed 32 bits at a time, either by the CPU or by
+ * memory-to-memory DMA.  The UART tasks share the single unit,
+ * so a mutex serializes each computation.
+ */
+
+#include "crc32.h"
+#include "app_os.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/crc.h"
+#include "fitterbap/log.h"
+#include "fitterbap/os/mutex.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32g4xx.h"
+#include "stm32g4xx_ll_bus.h"
+#include "stm32g4xx_ll_dma.h"
+#include "stm32g4xx_ll_dmamux.h"
+
+
+#define CRC32_DMA (0)               // 1 to feed long data by memory-to-memory DMA
+#define CRC32_DMA_WORDS_MIN (32)    // the minimum words to use DMA
+#define CRC32_DMA_CHANNEL LL_DMA_CHANNEL_3  // DMA2, channels 1 and 2 are UART5
+#define CRC32_BENCHMARK (0)         // 1 to log cycles per byte from crc32_benchmark()
+#define CRC32_BENCHMARK_SIZE (256)
+#define CRC32_BENCHMARK_ITERATIONS (64)
+#define CRC32_CHECK_VALUE (0xCBF43926U)  // CRC-32 of "123456789"
+
+#define REV_IN_BYTE (CRC_CR_REV_IN_0)
+#define REV_IN_WORD (CRC_CR_REV_IN_0 | CRC_CR_REV_IN_1)
+
+static fbp_os_mutex_t mutex_;
+
+
+static inline void rev_in_set(uint32_t rev_in) {
+    MODIFY_REG(CRC->CR, CRC_CR_REV_IN, rev_in);
+}
+
+static void dma_feed(uint32_t const * data, uint32_t words) {
+    LL_DMA_SetPeriphAddress(DMA2, CRC32_DMA_CHANNEL, (uint32_t) data);
+    LL_DMA_SetDataLength(DMA2, CRC32_DMA_CHANNEL, words);
+    WRITE_REG(DMA2->IFCR, DMA_IFCR_CGIF1 << (CRC32_DMA_CHANNEL * 4U));
+    LL_DMA_EnableChannel(DMA2, CRC32_DMA_CHANNEL);
+    // Far shorter than a context switch, so poll.
+    while (!READ_BIT(DMA2->ISR, (DMA_ISR_TCIF1 | DMA_ISR_TEIF1) << (CRC32_DMA_CHANNEL * 4U))) {
+    }
+    LL_DMA_DisableChannel(DMA2, CRC32_DMA_CHANNEL);
+}
+
+/**
+ * @brief Compute the CRC-32 using the CRC unit.
+ *
+ * @param crc The CRC from the previous call or 0 to start.
+ * @param data The data.
+ * @param length The size of data in bytes.
+ * @param dma_words_min The minimum aligned words to feed by DMA.
+ * @return The CRC-32.
+ *
+ * The caller must hold mutex_.
+ */
+static uint32_t crc32_hw(uint32_t crc, uint8_t const * data, uint32_t length, uint32_t dma_words_min) {
+    // The unit holds the unreflected state: reverse the reflected ~crc.
+    WRITE_REG(CRC->INIT, __RBIT(~crc));
+    SET_BIT(CRC->CR, CRC_CR_RESET);
+    rev_in_set(REV_IN_BYTE);
+    while (length && (((uintptr_t) data) & 3)) {
+        *((__IO uint8_t *) &CRC->DR) = *data++;
+        --length;
+    }
+    uint32_t words = length >> 2;
+    if (words) {
+        uint32_t const * data_u32 = (uint32_t const *) data;
+        rev_in_set(REV_IN_WORD);
+        if (words >= dma_words_min) {
+            dma_feed(data_u32, words);
+        } else {
+            for (uint32_t i = 0; i < words; ++i) {
+                CRC->DR = data_u32[i];
+            }
+        }
+        rev_in_set(REV_IN_BYTE);
+        data += words << 2;
+        length &= 3;
+    }
+    while (length--) {
+        *((__IO uint8_t *) &CRC->DR) = *data++;
+    }
+    return ~CRC->DR;
+}
+
+uint32_t app_crc32(uint32_t crc, uint8_t const * data, uint32_t length) {
+    fbp_os_mutex_lock(mutex_);
+    crc = crc32_hw(crc, data, length, CRC32_DMA ? CRC32_DMA_WORDS_MIN : UINT32_MAX);
+    fbp_os_mutex_unlock(mutex_);
+    return crc;
+}
+
+void crc32_initialize() {
+    mutex_ = app_mutex_alloc();
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_CRC);
+    WRITE_REG(CRC->POL, 0x04C11DB7U);
+    WRITE_REG(CRC->CR, CRC_CR_REV_OUT | REV_IN_BYTE);  // 32-bit polynomial
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+    LL_DMA_ConfigTransfer(DMA2, CRC32_DMA_CHANNEL,
+                          LL_DMA_DIRECTION_MEMORY_TO_MEMORY | LL_DMA_PRIORITY_LOW | LL_DMA_MODE_NORMAL
+                          | LL_DMA_PERIPH_INCREMENT | LL_DMA_MEMORY_NOINCREMENT
+                          | LL_DMA_PDATAALIGN_WORD | LL_DMA_MDATAALIGN_WORD);
+    LL_DMA_SetPeriphRequest(DMA2, CRC32_DMA_CHANNEL, LL_DMAMUX_REQ_MEM2MEM);
+    LL_DMA_SetMemoryAddress(DMA2, CRC32_DMA_CHANNEL, (uint32_t) &CRC->DR);
+
+#if CRC32_BENCHMARK
+    crc32_sw_initialize();  // otherwise unused, and the linker drops the 8 kB of tables
+#endif
+    if (CRC32_CHECK_VALUE != app_crc32(0, (uint8_t const *) "123456789", 9)) {
+        FBP_FATAL("crc32");
+    }
+}
+
+#if CRC32_BENCHMARK
+
+static uint32_t crc32_hw_cpu(uint32_t crc, uint8_t const * data, uint32_t length) {
+    return crc32_hw(crc, data, length, UINT32_MAX);
+}
+
+static uint32_t crc32_hw_dma(uint32_t crc, uint8_t const * data, uint32_t length) {
+    return crc32_hw(crc, data, length, 1);
+}
+
+typedef uint32_t (*crc32_fn)(uint32_t crc, uint8_t const * data, uint32_t length);
+
+static void benchmark_run(const char * name, crc32_fn fn, uint8_t const * data) {
+    uint32_t rv = 0;
+    taskENTER_CRITICAL();
+    uint32_t t_start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < CRC32_BENCHMARK_ITERATIONS; ++i) {
+        rv = fn(0, data, CRC32_BENCHMARK_SIZE);
+    }
+    uint32_t cycles = DWT->CYCCNT - t_start;
+    taskEXIT_CRITICAL();
+    uint32_t cpb100 = (cycles * 100U) / (CRC32_BENCHMARK_ITERATIONS * CRC32_BENCHMARK_SIZE);
+    FBP_LOGI("crc32 %s: %lu.%02lu cycles/byte, crc=0x%08lx", name,
+             (unsigned long) (cpb100 / 100), (unsigned long) (cpb100 % 100), (unsigned long) rv);
+}
+
+void crc32_benchmark() {
+    static uint32_t buffer_u32[CRC32_BENCHMARK_SIZE / 4];
+    uint8_t * buffer = (uint8_t *) buffer_u32;
+    for (uint32_t i = 0; i < CRC32_BENCHMARK_SIZE; ++i) {
+        buffer[i] = (uint8_t) (i * 7);
+    }
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    fbp_os_mutex_lock(mutex_);  // hold the CRC unit for all runs
+    benchmark_run("fbp_crc32", fbp_crc32, buffer);
+    benchmark_run("slicing8", crc32_sw, buffer);
+    benchmark_run("hw", crc32_hw_cpu, buffer);
+    benchmark_run("hw_dma", crc32_hw_dma, buffer);
+    fbp_os_mutex_unlock(mutex_);
+}
+
+#else
+
+void crc32_benchmark() {
+}
+
+#endif
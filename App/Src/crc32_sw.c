@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020-2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crc32.h"
+
+#define CRC32_POLYNOMIAL_REFLECTED (0xEDB88320U)
+
+static uint32_t table_[8][256];
+
+// The CRC of each 4-bit value, for crc32_sw_small().
+static const uint32_t NIBBLE_TABLE[16] = {
+    0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+    0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+    0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+    0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU,
+};
+
+
+void crc32_sw_initialize() {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? CRC32_POLYNOMIAL_REFLECTED : 0);
+        }
+        table_[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) {
+            uint32_t crc = table_[k - 1][i];
+            table_[k][i] = (crc >> 8) ^ table_[0][crc & 0xff];
+        }
+    }
+}
+
+uint32_t crc32_sw(uint32_t crc, uint8_t const * data, uint32_t length) {
+    crc = ~crc;
+    // process bytes until aligned
+    while (length && (((uintptr_t) data) & 3)) {
+        crc = (crc >> 8) ^ table_[0][(crc ^ *data++) & 0xff];
+        --length;
+    }
+    // process 8 bytes at a time, little-endian
+    while (length >= 8) {
+        uint32_t w0 = ((uint32_t const *) data)[0] ^ crc;
+        uint32_t w1 = ((uint32_t const *) data)[1];
+        crc = table_[7][w0 & 0xff] ^ table_[6][(w0 >> 8) & 0xff]
+            ^ table_[5][(w0 >> 16) & 0xff] ^ table_[4][w0 >> 24]
+            ^ table_[3][w1 & 0xff] ^ table_[2][(w1 >> 8) & 0xff]
+            ^ table_[1][(w1 >> 16) & 0xff] ^ table_[0][w1 >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = (crc >> 8) ^ table_[0][(crc ^ *data++) & 0xff];
+    }
+    return ~crc;
+}
+
+uint32_t crc32_sw_small(uint32_t crc, uint8_t const * data, uint32_t length) {
+    crc = ~crc;
+    while (length--) {
+        uint8_t b = *data++;
+        crc = (crc >> 4) ^ NIBBLE_TABLE[(crc ^ b) & 0x0f];
+        crc = (crc >> 4) ^ NIBBLE_TABLE[(crc ^ (b >> 4)) & 0x0f];
+    }
+    return ~crc;
+}
@@ -14,27 +14,55 @@
  * limitations under the License.
  */
 
+#include "fitterbap_support.h"
+#include "app_os.h"
+#include "isr.h"
+#include "log_bin.h"
 #include "fitterbap/assert.h"
 #include "fitterbap/log.h"
 #include "fitterbap/time.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "stm32g4xx.h"
+#include "stm32g4xx_ll_bus.h"
+
+
+/*
+ * The time counter is the free-running 32-bit TIM2 at the full timer
+ * clock, 170 MHz, which gives 5.9 ns resolution.  TIM2 wraps every 25
+ * seconds, so its update interrupt extends the count to 64 bits.
+ *
+ * fbp_time_counter() reports the same count at FBP_COUNTER_FREQUENCY.
+ * fitterbap converts counter values to FBP_TIME as (value << 30) /
+ * frequency, which overflows int64 after 2**33 counts: 50 seconds at
+ * 170 MHz, but 99 days at 1 kHz, beyond the 49.7 day wrap of the
+ * FreeRTOS tick count.
+ */
+#define FBP_COUNTER_FREQUENCY (1000U)
+static volatile uint32_t time_hi_ = 0;
+static uint32_t time_frequency_ = FBP_COUNTER_FREQUENCY;  // until time_initialize()
 
 void fbp_fatal(char const * file, int line, char const * msg) {
-    (void) file;
-    (void) line;
-    (void) msg;
     taskDISABLE_INTERRUPTS();
+    log_bin_fatal(file, (uint32_t) line, msg);
+    if (0 == (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk)) {
+        NVIC_SystemReset();  // replay the log on the next boot
+    }
     while (1) {
-        // stall forever: watchdog should cause reset
+        // stall forever for the debugger
     }
 }
 
 static void * hal_alloc(fbp_size_t size_bytes) {
+#if APP_STATIC_ALLOC
+    void * p = app_pool_alloc((uint32_t) size_bytes);
+    if (!p) {
+        size_t sz = app_pool_free();
+#else
     void * p = pvPortMalloc((size_t) size_bytes);
     if (!p) {
         size_t sz = xPortGetFreeHeapSize();
+#endif
         FBP_LOGE("alloc(%d) but only %d remain", (int) size_bytes, (int) sz);
         FBP_FATAL("alloc");
     }
@@ -46,14 +74,53 @@ static void hal_free(void * ptr) {
     vPortFree(ptr);
 }
 
+static void time_initialize() {
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM2);
+    time_frequency_ = SystemCoreClock;  // APB1 prescaler is 1, see SystemClock_Config()
+    TIM2->CR1 = 0;
+    TIM2->PSC = 0;
+    TIM2->ARR = 0xffffffffU;
+    TIM2->CNT = 0;
+    TIM2->EGR = TIM_EGR_UG;  // load PSC
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+    NVIC_SetPriority(TIM2_IRQn, ISR_TIME);
+    NVIC_EnableIRQ(TIM2_IRQn);
+    TIM2->CR1 = TIM_CR1_CEN;
+}
+
+void TIM2_IRQHandler(void) {
+    if (TIM2->SR & TIM_SR_UIF) {
+        TIM2->SR = (uint32_t) ~TIM_SR_UIF;
+        ++time_hi_;
+    }
+}
+
 void fitterbap_support_initialize() {
     fbp_allocator_set(hal_alloc, hal_free);
+    time_initialize();
 }
 
-FBP_API struct fbp_time_counter_s fbp_time_counter() {
+struct fbp_time_counter_s fitterbap_support_counter() {
     struct fbp_time_counter_s counter;
-    counter.value = xTaskGetTickCount();
-    counter.frequency = 1000;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t hi = time_hi_;
+    uint32_t lo = TIM2->CNT;
+    // The caller may block TIM2_IRQHandler, such as from a higher
+    // priority ISR.  Account for a wrap that is still pending.
+    if ((TIM2->SR & TIM_SR_UIF) && (lo < 0x80000000U)) {
+        ++hi;
+    }
+    __set_PRIMASK(primask);
+    counter.value = (((uint64_t) hi) << 32) | lo;
+    counter.frequency = time_frequency_;
     return counter;
 }
 
+FBP_API struct fbp_time_counter_s fbp_time_counter() {
+    struct fbp_time_counter_s counter = fitterbap_support_counter();
+    counter.value /= time_frequency_ / FBP_COUNTER_FREQUENCY;  // exact, 170 MHz / 1 kHz
+    counter.frequency = FBP_COUNTER_FREQUENCY;
+    return counter;
+}
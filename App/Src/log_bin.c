@@ -0,0 +1,406 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log_bin.h"
+#include "log_ring.h"
+#include "app_comms.h"
+#include "crc32.h"
+#include "fitterbap/cdef.h"
+#include "fitterbap/ec.h"
+#include "fitterbap/log.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define LOG_BIN_PUBLISH_MAX (256)
+#define HEADER_SIZE (8)
+#define PERSIST_MAGIC (0x4c4f4742)  // "BGOL"
+#define FATAL_FILE_MAX (32)
+#define FATAL_MSG_MAX (48)
+#define FATAL_STR_MAX (FATAL_FILE_MAX + FATAL_MSG_MAX + 16)
+#if APP_LOG_BINARY
+#define PERSIST_RING_SIZE (LOG_BIN_BUFFER_SIZE)
+#else
+#define PERSIST_RING_SIZE (0)  // text mode only keeps the fatal error
+#endif
+
+FBP_STATIC_ASSERT((LOG_BIN_BUFFER_SIZE & (LOG_BIN_BUFFER_SIZE - 1)) == 0, log_bin_buffer_size_power_of_2);
+FBP_STATIC_ASSERT(LOG_BIN_RECORD_MAX <= LOG_BIN_PUBLISH_MAX, log_bin_record_fits_publish);
+
+static const char FATAL_TOPIC[] = "log/fatal";
+
+static const char FATAL_META[] =
+    "{"
+        "\"dtype\": \"str\","
+        "\"brief\": \"The fatal error that caused the last reset.\","
+        "\"default\": \"\","
+        "\"flags\": [\"ro\"]"
+    "}";
+
+#if APP_LOG_BINARY
+static const char TOPIC[] = "log/bin";
+static const char DROPS_TOPIC[] = "log/drops";
+
+static const char META[] =
+    "{"
+        "\"dtype\": \"bin\","
+        "\"brief\": \"Binary log records, see tools/log_bin_decode.py.\","
+        "\"flags\": [\"ro\"]"
+    "}";
+
+static const char DROPS_META[] =
+    "{"
+        "\"dtype\": \"u32\","
+        "\"brief\": \"Binary log records dropped when the ring was full.\","
+        "\"default\": 0,"
+        "\"flags\": [\"ro\"]"
+    "}";
+#endif
+
+/*
+ * The log ring and the last fatal error survive a reset in .noinit.
+ * In text mode, only the fatal error does.
+ * The header CRC covers the ring geometry and the log_fmt section, so
+ * records from other firmware are discarded.  The fatal CRC is only
+ * valid after log_bin_fatal().
+ */
+struct persist_s {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t fmt_crc;
+    uint32_t crc;
+    uint32_t fatal_line;
+    char fatal_file[FATAL_FILE_MAX];
+    char fatal_msg[FATAL_MSG_MAX];
+    uint32_t fatal_crc;
+#if APP_LOG_BINARY
+    struct log_ring_s ring;
+    uint32_t buffer[LOG_BIN_BUFFER_SIZE / 4];
+#endif
+};
+
+extern const char __start_log_fmt[];  // provided by the linker
+extern const char __stop_log_fmt[];
+
+/*
+ * Keep log_fmt non-empty.  Without a LOG_BIN_PUBLISH call site, such as
+ * in text mode, the host linker would not define __start_log_fmt.
+ */
+static const char log_fmt_anchor_[] __attribute__((section("log_fmt"), used)) = "";
+
+static struct persist_s persist_ __attribute__((section(".noinit")));
+static char fatal_[FATAL_STR_MAX];
+static volatile uint8_t initialized_ = 0;
+static log_bin_on_publish on_publish_fn_ = 0;
+static void * on_publish_user_data_ = 0;
+static uint8_t meta_ = 0;
+
+#if APP_LOG_BINARY
+static struct log_ring_s * const ring_ = &persist_.ring;
+static uint32_t replay_ = 0;
+static uint8_t publish_buffer_[LOG_BIN_PUBLISH_MAX];
+static uint32_t drops_ = 0;
+
+static inline uint8_t * put_u32(uint8_t * p, uint32_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+    p[2] = (uint8_t) (v >> 16);
+    p[3] = (uint8_t) (v >> 24);
+    return p + 4;
+}
+
+static inline int is_digit(char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+/*
+ * Copy the arguments in format order.  This only walks the conversion
+ * specifiers, which is far cheaper than formatting them.  Returns the
+ * end of the record or NULL if the arguments do not fit.
+ */
+static uint8_t * args_pack(uint8_t * p, uint8_t * end, const char * f, va_list args) {
+    char c;
+    while ((c = *f++) && (c != LOG_BIN_SEP)) {
+        if (c != '%') {
+            continue;
+        }
+        while ((*f == '-') || (*f == '+') || (*f == ' ') || (*f == '#') || (*f == '0')) {
+            ++f;
+        }
+        for (int part = 0; part < 2; ++part) {  // width, then precision
+            if (*f == '*') {
+                if ((p + 4) > end) {
+                    return 0;
+                }
+                p = put_u32(p, (uint32_t) va_arg(args, int));
+                ++f;
+            }
+            while (is_digit(*f)) {
+                ++f;
+            }
+            if (*f != '.') {
+                break;
+            }
+            ++f;
+        }
+        int longlong = 0;
+        while ((*f == 'l') || (*f == 'h') || (*f == 'z') || (*f == 'j') || (*f == 't')) {
+            longlong += (*f++ == 'l') ? 1 : 0;
+        }
+        switch (*f++) {
+            case '%':
+                break;
+            case 's': {
+                const char * s = va_arg(args, const char *);
+                s = s ? s : "(null)";
+                uint32_t k = 0;
+                while (s[k] && (k < (LOG_BIN_STR_MAX - 1)) && ((p + k + 1) < end)) {
+                    p[k] = (uint8_t) s[k];
+                    ++k;
+                }
+                if ((p + k) >= end) {
+                    return 0;
+                }
+                p[k] = 0;
+                p += k + 1;
+                break;
+            }
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                double d = va_arg(args, double);
+                uint64_t v;
+                __builtin_memcpy(&v, &d, sizeof(v));
+                if ((p + 8) > end) {
+                    return 0;
+                }
+                p = put_u32(put_u32(p, (uint32_t) v), (uint32_t) (v >> 32));
+                break;
+            }
+            case 0:
+                return p;
+            default:
+                if (longlong >= 2) {
+                    uint64_t v = va_arg(args, unsigned long long);
+                    if ((p + 8) > end) {
+                        return 0;
+                    }
+                    p = put_u32(put_u32(p, (uint32_t) v), (uint32_t) (v >> 32));
+                } else if ((p + 4) > end) {
+                    return 0;
+                } else if (f[-1] == 'p') {
+                    p = put_u32(p, (uint32_t) (uintptr_t) va_arg(args, void *));
+                } else if (longlong) {
+                    p = put_u32(p, (uint32_t) va_arg(args, unsigned long));
+                } else {
+                    p = put_u32(p, va_arg(args, unsigned int));
+                }
+                break;
+        }
+    }
+    return p;
+}
+#endif
+
+static inline uint32_t persist_crc(uint8_t const * start, uint8_t const * end) {
+    // Not crc32_sw(), whose tables are empty when fbp_fatal() runs before crc32_initialize().
+    return crc32_sw_small(0, start, (uint32_t) (end - start));
+}
+
+static void str_copy(char * dst, const char * src, uint32_t dst_size) {
+    uint32_t k = 0;
+    while (src && src[k] && (k < (dst_size - 1))) {
+        dst[k] = src[k];
+        ++k;
+    }
+    dst[k] = 0;
+}
+
+static void fatal_restore(struct persist_s * p) {
+    uint32_t crc = persist_crc((uint8_t *) &p->fatal_line, (uint8_t *) &p->fatal_crc);
+    if (crc == p->fatal_crc) {
+        p->fatal_file[FATAL_FILE_MAX - 1] = 0;
+        p->fatal_msg[FATAL_MSG_MAX - 1] = 0;
+        char line[11];
+        uint32_t k = sizeof(line) - 1;
+        uint32_t v = p->fatal_line;
+        line[k] = 0;
+        do {
+            line[--k] = (char) ('0' + (v % 10));
+            v /= 10;
+        } while (v && k);
+        char * f = fatal_;
+        char * end = fatal_ + sizeof(fatal_) - 1;
+        const char * parts[] = {p->fatal_file, ":", line + k, ": ", p->fatal_msg};
+        for (uint32_t i = 0; i < FBP_ARRAY_SIZE(parts); ++i) {
+            for (const char * c = parts[i]; *c && (f < end); ++c) {
+                *f++ = *c;
+            }
+        }
+        *f = 0;
+    }
+    p->fatal_crc = ~crc;  // report once
+}
+
+void log_bin_initialize() {
+    struct persist_s * p = &persist_;
+    uint32_t fmt_crc = persist_crc((uint8_t const *) __start_log_fmt, (uint8_t const *) __stop_log_fmt);
+    if ((p->magic == PERSIST_MAGIC) && (p->size == PERSIST_RING_SIZE) && (p->fmt_crc == fmt_crc)
+            && (p->crc == persist_crc((uint8_t *) p, (uint8_t *) &p->crc))) {
+        fatal_restore(p);
+#if APP_LOG_BINARY
+        replay_ = log_ring_recover(ring_, p->buffer, sizeof(p->buffer));
+#endif
+    } else {
+        p->magic = PERSIST_MAGIC;
+        p->size = PERSIST_RING_SIZE;
+        p->fmt_crc = fmt_crc;
+        p->crc = persist_crc((uint8_t *) p, (uint8_t *) &p->crc);
+        p->fatal_crc = ~persist_crc((uint8_t *) &p->fatal_line, (uint8_t *) &p->fatal_crc);
+#if APP_LOG_BINARY
+        log_ring_initialize(ring_, p->buffer, sizeof(p->buffer));
+#endif
+    }
+    initialized_ = 1;
+}
+
+void log_bin_fatal(const char * file, uint32_t line, const char * msg) {
+    struct persist_s * p = &persist_;
+    if (p->magic != PERSIST_MAGIC) {
+        return;  // not yet initialized
+    }
+    if (file) {
+        const char * s = file;
+        while (*s) {  // keep the filename, which identifies the source
+            if ((*s == '/') || (*s == '\\')) {
+                file = s + 1;
+            }
+            ++s;
+        }
+    }
+    p->fatal_line = line;
+    str_copy(p->fatal_file, file, sizeof(p->fatal_file));
+    str_copy(p->fatal_msg, msg, sizeof(p->fatal_msg));
+    p->fatal_crc = persist_crc((uint8_t *) &p->fatal_line, (uint8_t *) &p->fatal_crc);
+}
+
+int32_t log_bin_publish(uint8_t level, const char * fmt, ...) {
+#if !APP_LOG_BINARY
+    (void) level;
+    (void) fmt;
+    return FBP_ERROR_UNAVAILABLE;
+#else
+    uint8_t record[LOG_BIN_RECORD_MAX];
+    va_list args;
+    if (!initialized_) {
+        return FBP_ERROR_UNAVAILABLE;
+    }
+    va_start(args, fmt);
+    uint8_t * end = args_pack(record + HEADER_SIZE, record + sizeof(record), fmt, args);
+    va_end(args);
+    if (!end) {
+        end = record + HEADER_SIZE;  // keep the call site, drop the arguments
+    }
+    uint32_t id = (uint32_t) (fmt - __start_log_fmt);
+    uint32_t size = (uint32_t) (end - record);
+    record[0] = level;
+    record[1] = (uint8_t) size;
+    record[2] = (uint8_t) id;
+    record[3] = (uint8_t) (id >> 8);
+    put_u32(record + 4, (uint32_t) xTaskGetTickCountFromISR());  // valid for tasks too
+
+    uint8_t * p = log_ring_reserve(ring_, size);
+    if (!p) {
+        return FBP_ERROR_FULL;
+    }
+    memcpy(p, record, size);
+    log_ring_commit(ring_, p, size);
+    if ((log_ring_fill(ring_) >= (LOG_BIN_BUFFER_SIZE / 2)) && on_publish_fn_) {
+        on_publish_fn_(on_publish_user_data_);
+    }
+    return 0;
+#endif
+}
+
+void log_bin_publish_register(log_bin_on_publish fn, void * user_data) {
+    on_publish_fn_ = 0;
+    on_publish_user_data_ = user_data;
+    on_publish_fn_ = fn;
+}
+
+int32_t log_bin_process() {
+    int32_t rc = 0;
+    if (!initialized_) {
+        return 0;
+    }
+    if (!meta_) {
+        meta_ = 1;
+        app_meta(FATAL_TOPIC, FATAL_META);
+        struct fbp_union_s value = {
+                .type = FBP_UNION_STR,
+                .flags = FBP_UNION_FLAG_RETAIN,
+                .op = 0,
+                .app = 0,
+                .size = (uint32_t) (strlen(fatal_) + 1),
+                .value = {.str = fatal_},
+        };
+        app_publish(FATAL_TOPIC, &value, NULL, NULL);
+#if APP_LOG_BINARY
+        app_meta(TOPIC, META);
+        app_meta(DROPS_TOPIC, DROPS_META);
+        if (replay_) {
+            FBP_LOGW("replay %lu log records from before reset", (unsigned long) replay_);
+        }
+#endif
+    }
+#if APP_LOG_BINARY
+    // Records stay in the ring until published, so a full pubsub
+    // buffer delays them rather than losing them.
+    uint8_t * record;
+    uint32_t record_size = 0;
+    while ((record = log_ring_peek(ring_, &record_size)) != 0) {
+        uint32_t size = 0;
+        uint32_t count = 0;
+        do {
+            if ((size + record_size) > sizeof(publish_buffer_)) {
+                break;
+            }
+            memcpy(publish_buffer_ + size, record, record_size);
+            size += record_size;
+            ++count;
+        } while ((record = log_ring_peek_next(ring_, record, &record_size)) != 0);
+        struct fbp_union_s value = {
+                .type = FBP_UNION_BIN,
+                .flags = 0,
+                .op = 0,
+                .app = 0,
+                .size = size,
+                .value = {.bin = publish_buffer_},
+        };
+        rc = app_publish(TOPIC, &value, NULL, NULL);
+        if (rc) {
+            break;  // retry on the next call
+        }
+        while (count--) {
+            log_ring_pop(ring_);
+        }
+    }
+    uint32_t drops = ring_->drops;
+    if ((drops != drops_) && !app_publish(DROPS_TOPIC, &fbp_union_u32_r(drops), NULL, NULL)) {
+        drops_ = drops;
+    }
+#endif
+    return rc;
+}
@@ -15,6 +15,8 @@
  */
 
 #include "log_handler.h"
+#include "log_bin.h"
+#include "app_os.h"
 #include "fitterbap/logh.h"
 #include "fitterbap/cdef.h"
 #include "cmsis_os.h"
@@ -25,10 +27,21 @@
 
 #define LOG_TASK_STACK (256)
 #define LOG_TASK_PRIORITY ((osPriority_t) osPriorityBelowNormal)
+#if APP_LOG_BINARY
+#define LOG_SERVICE_TIME_MAX_MS (100)  // batch binary records for up to 100 ms
+#else
 #define LOG_SERVICE_TIME_MAX_MS (500)
+#endif
 #define LOG_MSG_BUFFERS_MAX (10)
 
+#if defined(__ARM_ARCH)
+#define IN_ISR() xPortIsInsideInterrupt()
+#else
+#define IN_ISR() (0)  // the POSIX host port has no interrupts
+#endif
+
 static TaskHandle_t task_;
+APP_TASK_MEMORY(log, LOG_TASK_STACK);
 struct fbp_port_api_s * log_handler_api;
 
 enum events_e {
@@ -37,7 +50,13 @@ enum events_e {
 
 static void on_publish(void * user_data) {
     (void) user_data;
-    if (task_) {
+    if (!task_) {
+        return;
+    } else if (IN_ISR()) {  // binary records may come from ISRs
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xTaskNotifyFromISR(task_, EV_PUBLISH, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
         xTaskNotify(task_, EV_PUBLISH, eSetBits);
     }
 }
@@ -48,25 +67,30 @@ static void log_task(void *argument) {
     uint32_t wait;
     int32_t rc = 0;
     fbp_logh_publish_register(logh, on_publish, logh);
+    log_bin_publish_register(on_publish, NULL);
     while (1) {
         notify = 0;
         wait = rc ? 1 : LOG_SERVICE_TIME_MAX_MS;
         xTaskNotifyWait(0, 0xffffffff, &notify, wait);
         rc = fbp_logh_process(logh);
+        rc |= log_bin_process();
         // todo watchdog pet
     }
 }
 
 struct fbp_logh_s * log_handler_factory(const char * topic) {
     struct fbp_logh_s * logh = fbp_logh_initialize(topic[0], LOG_MSG_BUFFERS_MAX, NULL);
+    log_bin_initialize();
 
-    if (pdTRUE != xTaskCreate(
+    if (pdTRUE != app_task_create(
             log_task,            /* pvTaskCode */
             "log",               /* pcName */
             LOG_TASK_STACK,      /* usStackDepth in 32-bit words */
             logh,                /* pvParameters */
             LOG_TASK_PRIORITY,   /* uxPriority */
-            &task_)) {
+            &task_,              /* pxCreatedTask */
+            APP_TASK_STACK(log),
+            APP_TASK_TCB(log))) {
         FBP_FATAL("log task");
     }
     return logh;
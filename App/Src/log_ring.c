@@ -0,0 +1,177 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log_ring.h"
+#include "fitterbap/assert.h"
+
+
+// Header: bit 31 commit, bit 30 padding, bits 16-29 record size, bits 0-15 total size
+#define HDR_COMMIT      (0x80000000U)
+#define HDR_PAD         (0x40000000U)
+#define HDR_SIZE_POS    (16)
+#define HDR_SIZE_MASK   (0x3fffU)
+#define HDR_TOTAL_MASK  (0xffffU)
+
+static inline uint32_t total_size(uint32_t size) {
+    return 4 + ((size + 3) & ~3U);
+}
+
+static inline uint32_t * hdr_ptr(struct log_ring_s * self, uint32_t position) {
+    return self->buffer + ((position & (self->size - 1)) >> 2);
+}
+
+void log_ring_initialize(struct log_ring_s * self, uint32_t * buffer, uint32_t size) {
+    FBP_ASSERT(size && ((size & (size - 1)) == 0) && (size <= HDR_TOTAL_MASK));
+    self->head = 0;
+    self->tail = 0;
+    self->drops = 0;
+    self->size = size;
+    self->buffer = buffer;
+    for (uint32_t i = 0; i < (size >> 2); ++i) {
+        buffer[i] = 0;
+    }
+}
+
+uint32_t log_ring_recover(struct log_ring_s * self, uint32_t * buffer, uint32_t size) {
+    uint32_t head = self->head;
+    uint32_t tail = self->tail;
+    uint32_t count = 0;
+    if ((self->size != size) || ((head | tail) & 3) || ((head - tail) > size)) {
+        log_ring_initialize(self, buffer, size);
+        return 0;
+    }
+    self->buffer = buffer;
+    self->drops = 0;
+    uint32_t position = tail;
+    while (position != head) {
+        uint32_t h = *hdr_ptr(self, position);
+        uint32_t total = h & HDR_TOTAL_MASK;
+        uint32_t offset = position & (size - 1);
+        if (!(h & HDR_COMMIT) || (total < 4) || (total & 3)
+                || ((offset + total) > size) || ((head - position) < total)) {
+            break;  // the reset interrupted this record
+        }
+        if (!(h & HDR_PAD)) {
+            if (total != total_size((h >> HDR_SIZE_POS) & HDR_SIZE_MASK)) {
+                break;
+            }
+            ++count;
+        }
+        position += total;
+    }
+    self->head = position;
+    for (; position != (tail + size); position += 4) {
+        *hdr_ptr(self, position) = 0;  // restore the zero free space
+    }
+    return count;
+}
+
+uint8_t * log_ring_reserve(struct log_ring_s * self, uint32_t size) {
+    uint32_t total = total_size(size);
+    uint32_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    uint32_t offset;
+    uint32_t pad;
+
+    if ((size > HDR_SIZE_MASK) || (total > (self->size >> 1))) {
+        __atomic_fetch_add(&self->drops, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    do {
+        uint32_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        offset = head & (self->size - 1);
+        pad = self->size - offset;
+        pad = (pad < total) ? pad : 0;
+        if ((head + pad + total - tail) > self->size) {
+            __atomic_fetch_add(&self->drops, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+    } while (!__atomic_compare_exchange_n(&self->head, &head, head + pad + total,
+                                          0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    if (pad) {
+        __atomic_store_n(hdr_ptr(self, head), HDR_COMMIT | HDR_PAD | pad, __ATOMIC_RELEASE);
+        head += pad;
+    }
+    return (uint8_t *) (hdr_ptr(self, head) + 1);
+}
+
+void log_ring_commit(struct log_ring_s * self, uint8_t * record, uint32_t size) {
+    (void) self;
+    uint32_t * hdr = ((uint32_t *) record) - 1;
+    __atomic_store_n(hdr, HDR_COMMIT | (size << HDR_SIZE_POS) | total_size(size), __ATOMIC_RELEASE);
+}
+
+uint8_t * log_ring_peek(struct log_ring_s * self, uint32_t * size) {
+    while (1) {
+        uint32_t tail = self->tail;
+        if (tail == __atomic_load_n(&self->head, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+        uint32_t * hdr = hdr_ptr(self, tail);
+        uint32_t h = __atomic_load_n(hdr, __ATOMIC_ACQUIRE);
+        if (!(h & HDR_COMMIT)) {
+            return 0;  // reserved, not yet committed
+        }
+        if (h & HDR_PAD) {
+            *hdr = 0;
+            __atomic_store_n(&self->tail, tail + (h & HDR_TOTAL_MASK), __ATOMIC_RELEASE);
+            continue;
+        }
+        *size = (h >> HDR_SIZE_POS) & HDR_SIZE_MASK;
+        return (uint8_t *) (hdr + 1);
+    }
+}
+
+uint8_t * log_ring_peek_next(struct log_ring_s * self, const uint8_t * record, uint32_t * size) {
+    uint32_t tail = self->tail;
+    uint32_t head = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    uint32_t offset = (uint32_t) (record - 4 - (uint8_t *) self->buffer);
+    uint32_t pos = tail + ((offset - tail) & (self->size - 1));
+    pos += *hdr_ptr(self, pos) & HDR_TOTAL_MASK;
+    while (pos != head) {
+        uint32_t * hdr = hdr_ptr(self, pos);
+        uint32_t h = __atomic_load_n(hdr, __ATOMIC_ACQUIRE);
+        if (!(h & HDR_COMMIT)) {
+            return 0;  // reserved, not yet committed
+        }
+        if (!(h & HDR_PAD)) {
+            *size = (h >> HDR_SIZE_POS) & HDR_SIZE_MASK;
+            return (uint8_t *) (hdr + 1);
+        }
+        pos += h & HDR_TOTAL_MASK;
+    }
+    return 0;
+}
+
+void log_ring_pop(struct log_ring_s * self) {
+    uint32_t tail = self->tail;
+    if (tail == __atomic_load_n(&self->head, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    uint32_t * hdr = hdr_ptr(self, tail);
+    uint32_t h = *hdr;
+    if (!(h & HDR_COMMIT)) {
+        return;
+    }
+    uint32_t total = h & HDR_TOTAL_MASK;
+    for (uint32_t i = 0; i < (total >> 2); ++i) {
+        hdr[i] = 0;
+    }
+    __atomic_store_n(&self->tail, tail + total, __ATOMIC_RELEASE);
+}
+
+uint32_t log_ring_fill(struct log_ring_s * self) {
+    return __atomic_load_n(&self->head, __ATOMIC_ACQUIRE) - self->tail;
+}
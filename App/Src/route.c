@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "route.h"
+#include "uart.h"
+#include "fitterbap/cdef.h"
+#include "fitterbap/ec.h"
+
+FBP_STATIC_ASSERT(ROUTE_PORT_COUNT == UART_COUNT, route_port_count);
+
+
+static inline int prefix_index(char prefix) {
+    int idx = prefix - 'a';
+    return ((idx < 0) || (idx >= ROUTE_PREFIX_COUNT)) ? -1 : idx;
+}
+
+// Select the best port for each prefix from the neighbor vectors.
+static int32_t recompute(struct route_s * self) {
+    int32_t changed = 0;
+    for (uint8_t x = 0; x < ROUTE_PREFIX_COUNT; ++x) {
+        uint8_t best = ROUTE_HOPS_MAX;
+        uint8_t port = ROUTE_PORT_NONE;
+        if (x == self->prefix) {
+            best = 0;
+        } else {
+            for (uint8_t p = 0; p < ROUTE_PORT_COUNT; ++p) {
+                if (!(self->port_up & (1 << p))) {
+                    continue;
+                }
+                uint8_t h = self->neighbor[p][x] + 1;
+                if (h < best) {  // ties keep the lowest port for a stable tree
+                    best = h;
+                    port = p;
+                }
+            }
+        }
+        if ((best != self->hops[x]) || (port != self->port[x])) {
+            self->hops[x] = best;
+            self->port[x] = port;
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+int32_t route_initialize(struct route_s * self, char prefix) {
+    int idx = prefix_index(prefix);
+    if (idx < 0) {
+        return FBP_ERROR_PARAMETER_INVALID;
+    }
+    self->prefix = (uint8_t) idx;
+    self->port_up = 0;
+    for (uint8_t x = 0; x < ROUTE_PREFIX_COUNT; ++x) {
+        self->port[x] = ROUTE_PORT_NONE;
+        self->hops[x] = ROUTE_HOPS_MAX;
+        for (uint8_t p = 0; p < ROUTE_PORT_COUNT; ++p) {
+            self->neighbor[p][x] = ROUTE_HOPS_MAX;
+        }
+    }
+    recompute(self);
+    return 0;
+}
+
+int32_t route_port_set(struct route_s * self, uint8_t port, int up) {
+    if (port >= ROUTE_PORT_COUNT) {
+        return 0;
+    }
+    if (up) {
+        self->port_up |= (1 << port);
+    } else {
+        self->port_up &= ~(1 << port);
+    }
+    // A new or lost neighbor starts with nothing reachable.
+    for (uint8_t x = 0; x < ROUTE_PREFIX_COUNT; ++x) {
+        self->neighbor[port][x] = ROUTE_HOPS_MAX;
+    }
+    return recompute(self);
+}
+
+void route_advertise(struct route_s * self, uint8_t port, uint8_t * hops) {
+    for (uint8_t x = 0; x < ROUTE_PREFIX_COUNT; ++x) {
+        // poisoned reverse: never offer a route back to its next hop
+        hops[x] = (self->port[x] == port) ? ROUTE_HOPS_MAX : self->hops[x];
+    }
+}
+
+int32_t route_update(struct route_s * self, uint8_t port, const uint8_t * hops) {
+    if ((port >= ROUTE_PORT_COUNT) || !(self->port_up & (1 << port))) {
+        return 0;
+    }
+    for (uint8_t x = 0; x < ROUTE_PREFIX_COUNT; ++x) {
+        self->neighbor[port][x] = (hops[x] > ROUTE_HOPS_MAX) ? ROUTE_HOPS_MAX : hops[x];
+    }
+    return recompute(self);
+}
+
+uint8_t route_next_hop(struct route_s * self, char prefix) {
+    int idx = prefix_index(prefix);
+    if (idx < 0) {
+        return ROUTE_PORT_NONE;
+    }
+    return self->port[idx];
+}
+
+uint8_t route_flood_mask(struct route_s * self, char prefix, uint8_t port) {
+    int idx = prefix_index(prefix);
+    uint8_t mask = 0;
+    if (idx < 0) {
+        return 0;
+    }
+    if ((port != ROUTE_PORT_NONE) && (port != self->port[idx])) {
+        return 0;  // reverse-path check failed: a duplicate from a loop
+    }
+    for (uint8_t p = 0; p < ROUTE_PORT_COUNT; ++p) {
+        // Only forward to neighbors that reach the source through us,
+        // which they signal with the poisoned reverse hop count.
+        if ((p != port) && (self->port_up & (1 << p))
+                && (self->neighbor[p][idx] >= ROUTE_HOPS_MAX)) {
+            mask |= (1 << p);
+        }
+    }
+    return mask;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sys_service.h"
+#include "app_comms.h"
+#include "app_os.h"
+#include "fitterbap_support.h"
+#include "fitterbap/cstr.h"
+#include "fitterbap/log.h"
+#include "fitterbap/time.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#define SYS_SERVICE_PERIOD_MS (1000)
+#define SYS_TASK_MAX (16)
+#define SYS_TASK_NAME_MAX (12)
+#define RUN_TIME_SHIFT (6)  // 2.66 MHz on target, wraps every 27 minutes
+
+
+struct task_s {
+    TaskHandle_t handle;
+    uint32_t run_time;      // ulRunTimeCounter at the last poll
+    uint32_t cpu;           // the last published values
+    uint32_t stack;
+    char name[SYS_TASK_NAME_MAX + 1];
+};
+
+static struct task_s tasks_[SYS_TASK_MAX];
+static uint32_t task_count_ = 0;
+static TaskStatus_t status_[SYS_TASK_MAX];
+static uint32_t run_time_ = 0;
+static uint32_t idle_ = UINT32_MAX;
+static TickType_t poll_tick_ = 0;
+static uint32_t heap_free_ = UINT32_MAX;
+static uint32_t pool_free_ = UINT32_MAX;
+
+static const char IDLE_TOPIC[] = "sys/idle";
+static const char HEAP_TOPIC[] = "sys/mem/heap";
+static const char POOL_TOPIC[] = "sys/mem/pool";
+
+static const char CPU_META[] =
+    "{"
+        "\"dtype\": \"u32\","
+        "\"brief\": \"CPU load in 0.01 %.\","
+        "\"default\": 0,"
+        "\"flags\": [\"ro\"]"
+    "}";
+
+static const char MEM_META[] =
+    "{"
+        "\"dtype\": \"u32\","
+        "\"brief\": \"Free memory in bytes.\","
+        "\"default\": 0,"
+        "\"flags\": [\"ro\"]"
+    "}";
+
+static const char STACK_META[] =
+    "{"
+        "\"dtype\": \"u32\","
+        "\"brief\": \"Minimum free task stack in bytes.\","
+        "\"default\": 0,"
+        "\"flags\": [\"ro\"]"
+    "}";
+
+
+/*
+ * The FreeRTOS run-time stats counter, which overrides the weak
+ * definitions in app_freertos.c.  It derives from the 64-bit
+ * fitterbap_support_counter(), so it needs no timer of its own.  The kernel
+ * and sys_service_poll() only use differences, which tolerate the
+ * 32-bit wrap.
+ */
+void configureTimerForRunTimeStats(void) {
+}
+
+unsigned long getRunTimeCounterValue(void) {
+    return (unsigned long) (fitterbap_support_counter().value >> RUN_TIME_SHIFT);
+}
+
+static void task_topic(char * topic, struct task_s * t, const char * field) {
+    char * p = topic;
+    fbp_cstr_copy(p, "sys/t/", FBP_PUBSUB_TOPIC_LENGTH_MAX);
+    p += 6;
+    fbp_cstr_copy(p, t->name, FBP_PUBSUB_TOPIC_LENGTH_MAX - (p - topic));
+    while (*p) {
+        ++p;
+    }
+    *p++ = '/';
+    fbp_cstr_copy(p, field, FBP_PUBSUB_TOPIC_LENGTH_MAX - (p - topic));
+}
+
+static struct task_s * task_find(TaskStatus_t * status) {
+    char topic[FBP_PUBSUB_TOPIC_LENGTH_MAX];
+    for (uint32_t i = 0; i < task_count_; ++i) {
+        if (tasks_[i].handle == status->xHandle) {
+            return &tasks_[i];
+        }
+    }
+    if (task_count_ >= SYS_TASK_MAX) {
+        return NULL;
+    }
+    struct task_s * t = &tasks_[task_count_++];
+    t->handle = status->xHandle;
+    t->run_time = 0;
+    t->cpu = UINT32_MAX;    // force the first publish
+    t->stack = UINT32_MAX;
+    // topic-safe name: "Tmr Svc" becomes "tmr_svc"
+    const char * src = status->pcTaskName;
+    uint32_t k = 0;
+    for (; src[k] && (k < SYS_TASK_NAME_MAX); ++k) {
+        char c = src[k];
+        if ((c >= 'A') && (c <= 'Z')) {
+            c = c - 'A' + 'a';
+        } else if (!(((c >= 'a') && (c <= 'z')) || ((c >= '0') && (c <= '9')))) {
+            c = '_';
+        }
+        t->name[k] = c;
+    }
+    t->name[k] = 0;
+    task_topic(topic, t, "cpu");
+    app_meta(topic, CPU_META);
+    task_topic(topic, t, "stack");
+    app_meta(topic, STACK_META);
+    return t;
+}
+
+void sys_service_initialize() {
+    app_meta(IDLE_TOPIC, CPU_META);
+    app_meta(HEAP_TOPIC, MEM_META);
+    app_meta(POOL_TOPIC, MEM_META);
+    poll_tick_ = xTaskGetTickCount();
+}
+
+void sys_service_poll() {
+    char topic[FBP_PUBSUB_TOPIC_LENGTH_MAX];
+    uint32_t run_time;
+    TickType_t now = xTaskGetTickCount();
+    if ((now - poll_tick_) < pdMS_TO_TICKS(SYS_SERVICE_PERIOD_MS)) {
+        return;
+    }
+    poll_tick_ = now;
+
+    uint32_t heap_free = (uint32_t) xPortGetFreeHeapSize();
+    if (heap_free != heap_free_) {
+        heap_free_ = heap_free;
+        app_publish(HEAP_TOPIC, &fbp_union_u32_r(heap_free), NULL, NULL);
+    }
+    uint32_t pool_free = app_pool_free();
+    if (pool_free != pool_free_) {
+        pool_free_ = pool_free;
+        app_publish(POOL_TOPIC, &fbp_union_u32_r(pool_free), NULL, NULL);
+    }
+
+    UBaseType_t count = uxTaskGetSystemState(status_, SYS_TASK_MAX, &run_time);
+    if (!count) {
+        FBP_LOGW("sys: more than %d tasks", SYS_TASK_MAX);
+        return;
+    }
+    uint32_t dt_total = run_time - run_time_;
+    run_time_ = run_time;
+    if (!dt_total) {
+        return;
+    }
+
+    for (UBaseType_t i = 0; i < count; ++i) {
+        TaskStatus_t * s = &status_[i];
+        struct task_s * t = task_find(s);
+        if (!t) {
+            continue;
+        }
+        uint32_t dt = ((uint32_t) s->ulRunTimeCounter) - t->run_time;
+        t->run_time = (uint32_t) s->ulRunTimeCounter;
+        uint32_t cpu = (uint32_t) ((((uint64_t) dt) * 10000U) / dt_total);
+        uint32_t stack = (uint32_t) (s->usStackHighWaterMark * sizeof(StackType_t));
+        if (cpu != t->cpu) {
+            t->cpu = cpu;
+            task_topic(topic, t, "cpu");
+            app_publish(topic, &fbp_union_u32_r(cpu), NULL, NULL);
+        }
+        if (stack != t->stack) {
+            t->stack = stack;
+            task_topic(topic, t, "stack");
+            app_publish(topic, &fbp_union_u32_r(stack), NULL, NULL);
+        }
+        if ((0 == strcmp(t->name, "idle")) && (cpu != idle_)) {
+            idle_ = cpu;
+            app_publish(IDLE_TOPIC, &fbp_union_u32_r(cpu), NULL, NULL);
+        }
+    }
+}
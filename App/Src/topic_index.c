@@ -0,0 +1,110 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "topic_index.h"
+#include "fitterbap/ec.h"
+
+
+#define FNV1A_OFFSET (2166136261U)
+#define FNV1A_PRIME (16777619U)
+
+
+// FNV-1a over the full topic, also returns the length for the arena copy.
+static uint32_t topic_hash(const char * topic, uint32_t * length) {
+    uint32_t hash = FNV1A_OFFSET;
+    const char * t = topic;
+    while (*t) {
+        hash = (hash ^ (uint8_t) *t++) * FNV1A_PRIME;
+    }
+    *length = (uint32_t) (t - topic);
+    return hash ? hash : 1;  // 0 marks an empty entry
+}
+
+static int topic_equal(const char * a, const char * b) {
+    while (*a && (*a == *b)) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+// Return the entry for topic, or the empty entry where it belongs.
+static struct topic_index_entry_s * entry_find(struct topic_index_s * self, const char * topic,
+                                               uint32_t hash) {
+    uint32_t idx = hash & self->mask;
+    while (1) {
+        struct topic_index_entry_s * e = &self->entries[idx];
+        if (!e->hash) {
+            return e;
+        } else if ((e->hash == hash) && topic_equal(self->arena + e->offset, topic)) {
+            return e;
+        }
+        idx = (idx + 1) & self->mask;
+    }
+}
+
+int32_t topic_index_initialize(struct topic_index_s * self,
+                               struct topic_index_entry_s * entries, uint32_t entry_count,
+                               char * arena, uint32_t arena_size) {
+    if (!entry_count || (entry_count & (entry_count - 1))) {
+        return FBP_ERROR_PARAMETER_INVALID;
+    }
+    for (uint32_t i = 0; i < entry_count; ++i) {
+        entries[i].hash = 0;
+        entries[i].offset = 0;
+        entries[i].value = 0;
+    }
+    self->entries = entries;
+    self->mask = entry_count - 1;
+    self->count = 0;
+    self->arena = arena;
+    self->arena_size = arena_size;
+    self->arena_used = 0;
+    return 0;
+}
+
+int32_t topic_index_add(struct topic_index_s * self, const char * topic, void * value) {
+    uint32_t length;
+    uint32_t hash = topic_hash(topic, &length);
+    struct topic_index_entry_s * e = entry_find(self, topic, hash);
+    if (e->hash) {
+        e->value = value;
+        return 0;
+    }
+    // keep the load factor at or below 3/4 so probe sequences stay short
+    if (((self->count + 1) * 4) > ((self->mask + 1) * 3)) {
+        return FBP_ERROR_FULL;
+    }
+    if ((self->arena_used + length + 1) > self->arena_size) {
+        return FBP_ERROR_FULL;
+    }
+    char * s = self->arena + self->arena_used;
+    for (uint32_t i = 0; i <= length; ++i) {
+        s[i] = topic[i];
+    }
+    e->hash = hash;
+    e->offset = self->arena_used;
+    e->value = value;
+    self->arena_used += length + 1;
+    ++self->count;
+    return 0;
+}
+
+void * topic_index_find(struct topic_index_s * self, const char * topic) {
+    uint32_t length;
+    uint32_t hash = topic_hash(topic, &length);
+    return entry_find(self, topic, hash)->value;
+}
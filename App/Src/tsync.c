@@ -0,0 +1,204 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tsync.h"
+#include "uart.h"
+#include "fitterbap/cdef.h"
+#include "fitterbap/ec.h"
+#include "fitterbap/time.h"
+
+FBP_STATIC_ASSERT(TSYNC_PORT_COUNT == UART_COUNT, tsync_port_count);
+
+
+#define DRIFT_Q (30)
+#define DRIFT_MAX (((int64_t) 1 << DRIFT_Q) / 1000)     // 1000 ppm
+#define DRIFT_BASELINE (16 * FBP_TIME_SECOND)           // drift measurement interval
+#define DRIFT_GAIN_SHIFT (1)                            // 1/2 per baseline
+#define OFFSET_GAIN_SHIFT (1)                           // 1/2 per selected sample
+#define DELAY_MARGIN (10 * FBP_TIME_MICROSECOND)        // accepted delay above the minimum
+#define DELAY_AGE_SHIFT (4)                             // minimum delay growth per rejected sample
+#define HOLDOVER_MAX (3600 * FBP_TIME_SECOND)           // stop extrapolating drift
+#define OFFSET_STEP_MAX (FBP_TIME_SECOND)               // larger changes restart the loop
+
+enum state_e {
+    STATE_FREE = 0,
+    STATE_HOLDOVER = 1,
+    STATE_LOCKED = 2,
+};
+
+
+static int64_t offset_model(struct tsync_s * self, int64_t local) {
+    int64_t dt = local - self->ref_local;
+    if (dt > HOLDOVER_MAX) {
+        dt = HOLDOVER_MAX;
+    } else if (dt < -HOLDOVER_MAX) {
+        dt = -HOLDOVER_MAX;
+    }
+    return self->ref_offset + ((dt * self->drift) >> DRIFT_Q);
+}
+
+static int32_t elect(struct tsync_s * self) {
+    uint8_t port = TSYNC_PORT_NONE;
+    uint8_t stratum = TSYNC_STRATUM_NONE;
+    if (self->root) {
+        stratum = 0;
+    } else {
+        for (uint8_t p = 0; p < TSYNC_PORT_COUNT; ++p) {
+            uint8_t s = self->port_stratum[p];
+            if ((self->client_mask & (1 << p)) && (s < TSYNC_STRATUM_MAX) && (s + 1 < stratum)) {
+                stratum = s + 1;   // ties keep the lowest port
+                port = p;
+            }
+        }
+    }
+    if ((port == self->port) && (stratum == self->stratum)) {
+        return 0;
+    }
+    if (port != self->port) {
+        // Keep serving the current model until the new source locks.
+        self->window_count = 0;
+        self->window_idx = 0;
+        if (self->state == STATE_LOCKED) {
+            self->state = STATE_HOLDOVER;
+        }
+    }
+    self->port = port;
+    self->stratum = stratum;
+    return 1;
+}
+
+void tsync_initialize(struct tsync_s * self, int root) {
+    uint8_t * p = (uint8_t *) self;
+    for (uint32_t i = 0; i < sizeof(*self); ++i) {
+        p[i] = 0;
+    }
+    self->root = root ? 1 : 0;
+    self->stratum = TSYNC_STRATUM_NONE;
+    self->port = TSYNC_PORT_NONE;
+    for (uint8_t i = 0; i < TSYNC_PORT_COUNT; ++i) {
+        self->port_stratum[i] = TSYNC_STRATUM_NONE;
+    }
+    elect(self);
+}
+
+int32_t tsync_port_set(struct tsync_s * self, uint8_t port, int client, uint8_t stratum) {
+    if (port >= TSYNC_PORT_COUNT) {
+        return 0;
+    }
+    if (client) {
+        self->client_mask |= (1 << port);
+    } else {
+        self->client_mask &= ~(1 << port);
+    }
+    self->port_stratum[port] = stratum;
+    return elect(self);
+}
+
+// Return the minimum-delay sample in the window.
+static struct tsync_sample_s * sample_select(struct tsync_s * self) {
+    struct tsync_sample_s * best = &self->window[0];
+    for (uint8_t i = 1; i < self->window_count; ++i) {
+        if (self->window[i].delay < best->delay) {
+            best = &self->window[i];
+        }
+    }
+    return best;
+}
+
+static void drift_update(struct tsync_s * self, struct tsync_sample_s * s) {
+    int64_t dt = s->local - self->drift_local;
+    if (dt < DRIFT_BASELINE) {
+        return;
+    }
+    // The offset model already includes the current drift estimate,
+    // so measure the raw drift over the whole baseline.
+    int64_t step = s->offset - self->drift_offset;
+    if ((step < OFFSET_STEP_MAX) && (step > -OFFSET_STEP_MAX)) {
+        int64_t drift = (step << DRIFT_Q) / dt;
+        self->drift += (drift - self->drift) >> DRIFT_GAIN_SHIFT;
+        if (self->drift > DRIFT_MAX) {
+            self->drift = DRIFT_MAX;
+        } else if (self->drift < -DRIFT_MAX) {
+            self->drift = -DRIFT_MAX;
+        }
+    }
+    self->drift_local = s->local;
+    self->drift_offset = s->offset;
+}
+
+int32_t tsync_update(struct tsync_s * self, uint8_t port,
+                     int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    if ((port == TSYNC_PORT_NONE) || (port != self->port)) {
+        return FBP_ERROR_UNAVAILABLE;
+    }
+    struct tsync_sample_s * s = &self->window[self->window_idx];
+    s->local = t1 + (t4 - t1) / 2;
+    s->offset = ((t2 - t1) + (t3 - t4)) / 2;
+    s->delay = (t4 - t1) - (t3 - t2);
+    if ((self->window_count == 0) || (s->delay < self->delay_min)) {
+        self->delay_min = s->delay;
+    }
+    if (++self->window_idx >= TSYNC_WINDOW) {
+        self->window_idx = 0;
+    }
+    if (self->window_count < TSYNC_WINDOW) {
+        ++self->window_count;
+    }
+
+    s = sample_select(self);
+    if ((self->state == STATE_LOCKED) && (s->local == self->selected_local)) {
+        return 0;  // each sample steers the loop only once
+    }
+    if (s->delay > (self->delay_min + DELAY_MARGIN)) {
+        // Queueing delayed every recent exchange, so none are trustworthy.
+        // Age the minimum so that a longer path is eventually accepted.
+        self->delay_min += (self->delay_min >> DELAY_AGE_SHIFT) + 1;
+        return 0;
+    }
+    self->selected_local = s->local;
+
+    if (self->state != STATE_FREE) {
+        int64_t predicted = offset_model(self, s->local);
+        int64_t error = s->offset - predicted;
+        if ((error < OFFSET_STEP_MAX) && (error > -OFFSET_STEP_MAX)) {
+            self->ref_offset = predicted + (error >> OFFSET_GAIN_SHIFT);
+            self->ref_local = s->local;
+            if (self->state == STATE_LOCKED) {
+                drift_update(self, s);
+            } else {
+                self->drift_local = s->local;  // new upstream: restart the baseline
+                self->drift_offset = s->offset;
+            }
+            self->state = STATE_LOCKED;
+            return 0;
+        }
+        // upstream time stepped: restart from this sample
+    }
+    self->ref_local = s->local;
+    self->ref_offset = s->offset;
+    self->drift_local = s->local;
+    self->drift_offset = s->offset;
+    self->drift = 0;
+    self->state = STATE_LOCKED;
+    return 0;
+}
+
+int64_t tsync_time(struct tsync_s * self, int64_t local) {
+    if (self->state == STATE_FREE) {
+        return local;
+    }
+    return local + offset_model(self, local);
+}
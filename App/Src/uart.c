@@ -0,0 +1,1042 @@
+/*
+ * Copyright 2020-2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "uart.h"
+#include "app_os.h"
+#include "fitterbap_support.h"
+#include "isr.h"
+#include "main.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/cdef.h"
+#include "fitterbap/ec.h"
+#include "fitterbap/log.h"
+#include "fitterbap/time.h"
+#include "fitterbap/collections/ring_buffer_u8.h"
+
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "stm32g4xx_hal.h"
+#include "stm32g4xx_ll_dma.h"
+#include "stm32g4xx_ll_bus.h"
+#include "stm32g4xx_ll_usart.h"
+#include "stm32g4xx_ll_gpio.h"
+#include "stm32g4xx_ll_rcc.h"
+
+
+#define UART_TASK_STACK (512)
+#define UART_COMMS_TASK_STACK (768)
+#define UART_TASK_PRIORITY ((osPriority_t) osPriorityNormal)
+#define UART_SERVICE_TIME_MAX_MS (500)
+#define UART_BAUD_SWITCH_DELAY_MS (50)  // time for the peer to receive its own switch request
+#define UART_RX_BUFFER_SIZE  (1024)  // 3.4 ms at 3 Mbaud
+#define UART1_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#define UART2_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#define UART3_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#define UART4_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#define UART5_RX_BUFFER_SIZE UART_RX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE  ((270 + 16) * 2)
+#define UART_TX_ISR (1)     // 1 to continue TX from the DMA ISR, 0 from the task
+#define UART_BENCHMARK (0)  // 1 to log TX utilization and ISR rate every second
+#define UART_FIFO (0)       // 1 to enable the 8-byte USART FIFOs, 0 for single byte
+#define UART_SINGLE_TASK (0)  // 1 to service all ports from one comms task
+#define UART_EV_BITS (4)    // notification bits per port, see events_e
+
+#if UART_SINGLE_TASK && ((UART_COUNT * UART_EV_BITS) > 32)
+#error "too many UART ports for the single task notification bitmap"
+#endif
+
+
+/// The constant hardware description for each UART instance.
+struct uart_config_s {
+    const char * name;
+    USART_TypeDef * usart;
+    IRQn_Type usart_irq;
+    uint8_t apb;                    // the APB bus: 1 or 2
+    uint32_t apb_periph;            // the LL_APBx_GRP1_PERIPH_* clock enable
+    uint32_t clk_source;            // LL_RCC_USARTx_CLKSOURCE or LL_RCC_UARTx_CLKSOURCE
+    GPIO_TypeDef * tx_port;
+    uint32_t tx_pin;
+    GPIO_TypeDef * rx_port;
+    uint32_t rx_pin;
+    uint32_t alternate;             // LL_GPIO_AF_*
+    DMA_TypeDef * dma;
+    uint32_t dma_rx_channel;        // LL_DMA_CHANNEL_*
+    IRQn_Type dma_rx_irq;
+    uint32_t dma_rx_request;        // LL_DMAMUX_REQ_*
+    uint32_t dma_tx_channel;        // LL_DMA_CHANNEL_*
+    IRQn_Type dma_tx_irq;
+    uint32_t dma_tx_request;        // LL_DMAMUX_REQ_*
+    uint8_t isr_priority;
+    uint8_t isr_priority_dma_rx;
+    uint8_t isr_priority_dma_tx;
+    uint32_t baudrate;
+    uint8_t * rx_buffer;            // the circular RX DMA buffer
+    uint32_t rx_buffer_size;
+};
+
+struct uart_s {
+    const struct uart_config_s * config;
+    volatile uint8_t active;           // uart_initialize() complete
+    uint8_t running;                   // usart_init() complete
+    uint8_t ev_shift;                  // events_e shift into the task notification value
+    uart_recv_fn recv_fn;
+    void * recv_user_data;
+    TaskHandle_t task;
+    volatile uint32_t rx_count;        // total bytes written by the RX DMA, published by the ISRs
+    uint32_t rx_dma_offset;            // RX DMA write offset at the last publish, ISR only
+    uint32_t rx_consumed;              // total bytes delivered to recv_fn, task only
+    volatile uint64_t rx_time;         // fitterbap_support_counter() when rx_count last advanced
+    uint32_t rx_latency_max;           // ISR to recv_fn delay, in time counter ticks
+    uint32_t rx_lap;                   // RX DMA overwrote unread data
+    uint32_t rx_backlog_max;
+    volatile uint32_t usart_ore;       // USART overrun errors
+    volatile uint32_t usart_fe;        // USART framing errors
+    volatile uint32_t usart_ne;        // USART noise errors
+    volatile uint32_t dma_te;          // DMA transfer errors
+    uint8_t tx_buffer[UART_TX_BUFFER_SIZE];
+    volatile uint32_t tx_dma_sz;       // total size of the active DMA transfer
+    volatile uint32_t tx_dma_next_sz;  // wrapped segment from buffer start, chained by ISR
+    volatile uint32_t tx_bytes;        // total bytes transmitted
+    volatile uint8_t tx_blocked;       // a sender is waiting for buffer space
+    volatile uint8_t tx_hold;          // refuse new TX data during a baud rate switch
+    uint32_t baudrate;
+    volatile uint32_t baudrate_pending;
+    uint32_t tx_fill_max;
+    struct fbp_rbu8_s tx_rbu8_;
+    struct fbp_evm_s * evm;
+    struct fbp_evm_api_s evm_api;
+    fbp_os_mutex_t mutex;
+#if APP_STATIC_ALLOC && !UART_SINGLE_TASK
+    StackType_t task_stack[UART_TASK_STACK];
+    StaticTask_t task_tcb;
+#endif
+#if UART_BENCHMARK
+    volatile uint32_t bench_isr_count;
+    uint32_t bench_isr_count_prev;
+    uint32_t bench_ore_prev;
+    uint32_t bench_tx_bytes;
+    uint32_t bench_start;
+#endif
+};
+
+enum events_e {
+    EV_RECV = (1 << 0),
+    EV_SEND = (1 << 1),
+    EV_SEND_DONE = (1 << 2),
+    EV_APP = (1 << 3),
+};
+
+static uint8_t uart1_rx_buffer_[UART1_RX_BUFFER_SIZE];
+static uint8_t uart2_rx_buffer_[UART2_RX_BUFFER_SIZE];
+static uint8_t uart3_rx_buffer_[UART3_RX_BUFFER_SIZE];
+static uint8_t uart4_rx_buffer_[UART4_RX_BUFFER_SIZE];
+static uint8_t uart5_rx_buffer_[UART5_RX_BUFFER_SIZE];
+
+static const struct uart_config_s configs_[UART_COUNT] = {
+    {
+        .name = "uart1",
+        .usart = USART1,
+        .usart_irq = USART1_IRQn,
+        .apb = 2,
+        .apb_periph = LL_APB2_GRP1_PERIPH_USART1,
+        .clk_source = LL_RCC_USART1_CLKSOURCE,
+        .tx_port = UART1_TX_GPIO_Port,
+        .tx_pin = UART1_TX_Pin,
+        .rx_port = UART1_RX_GPIO_Port,
+        .rx_pin = UART1_RX_Pin,
+        .alternate = LL_GPIO_AF_7,
+        .dma = DMA1,
+        .dma_rx_channel = LL_DMA_CHANNEL_1,
+        .dma_rx_irq = DMA1_Channel1_IRQn,
+        .dma_rx_request = LL_DMAMUX_REQ_USART1_RX,
+        .dma_tx_channel = LL_DMA_CHANNEL_2,
+        .dma_tx_irq = DMA1_Channel2_IRQn,
+        .dma_tx_request = LL_DMAMUX_REQ_USART1_TX,
+        .isr_priority = ISR_UART1,
+        .isr_priority_dma_rx = ISR_UART1_DMA_RX,
+        .isr_priority_dma_tx = ISR_UART1_DMA_TX,
+        .baudrate = UART_BAUDRATE_DEFAULT,
+        .rx_buffer = uart1_rx_buffer_,
+        .rx_buffer_size = sizeof(uart1_rx_buffer_),
+    },
+    {
+        .name = "uart2",
+        .usart = USART2,
+        .usart_irq = USART2_IRQn,
+        .apb = 1,
+        .apb_periph = LL_APB1_GRP1_PERIPH_USART2,
+        .clk_source = LL_RCC_USART2_CLKSOURCE,
+        .tx_port = UART2_TX_GPIO_Port,
+        .tx_pin = UART2_TX_Pin,
+        .rx_port = UART2_RX_GPIO_Port,
+        .rx_pin = UART2_RX_Pin,
+        .alternate = LL_GPIO_AF_7,
+        .dma = DMA1,
+        .dma_rx_channel = LL_DMA_CHANNEL_3,
+        .dma_rx_irq = DMA1_Channel3_IRQn,
+        .dma_rx_request = LL_DMAMUX_REQ_USART2_RX,
+        .dma_tx_channel = LL_DMA_CHANNEL_4,
+        .dma_tx_irq = DMA1_Channel4_IRQn,
+        .dma_tx_request = LL_DMAMUX_REQ_USART2_TX,
+        .isr_priority = ISR_UART2,
+        .isr_priority_dma_rx = ISR_UART2_DMA_RX,
+        .isr_priority_dma_tx = ISR_UART2_DMA_TX,
+        .baudrate = UART_BAUDRATE_DEFAULT,
+        .rx_buffer = uart2_rx_buffer_,
+        .rx_buffer_size = sizeof(uart2_rx_buffer_),
+    },
+    {
+        .name = "uart3",
+        .usart = USART3,
+        .usart_irq = USART3_IRQn,
+        .apb = 1,
+        .apb_periph = LL_APB1_GRP1_PERIPH_USART3,
+        .clk_source = LL_RCC_USART3_CLKSOURCE,
+        .tx_port = UART3_TX_GPIO_Port,
+        .tx_pin = UART3_TX_Pin,
+        .rx_port = UART3_RX_GPIO_Port,
+        .rx_pin = UART3_RX_Pin,
+        .alternate = LL_GPIO_AF_7,
+        .dma = DMA1,
+        .dma_rx_channel = LL_DMA_CHANNEL_5,
+        .dma_rx_irq = DMA1_Channel5_IRQn,
+        .dma_rx_request = LL_DMAMUX_REQ_USART3_RX,
+        .dma_tx_channel = LL_DMA_CHANNEL_6,
+        .dma_tx_irq = DMA1_Channel6_IRQn,
+        .dma_tx_request = LL_DMAMUX_REQ_USART3_TX,
+        .isr_priority = ISR_UART3,
+        .isr_priority_dma_rx = ISR_UART3_DMA_RX,
+        .isr_priority_dma_tx = ISR_UART3_DMA_TX,
+        .baudrate = UART_BAUDRATE_DEFAULT,
+        .rx_buffer = uart3_rx_buffer_,
+        .rx_buffer_size = sizeof(uart3_rx_buffer_),
+    },
+    {
+        .name = "uart4",
+        .usart = UART4,
+        .usart_irq = UART4_IRQn,
+        .apb = 1,
+        .apb_periph = LL_APB1_GRP1_PERIPH_UART4,
+        .clk_source = LL_RCC_UART4_CLKSOURCE,
+        .tx_port = UART4_TX_GPIO_Port,
+        .tx_pin = UART4_TX_Pin,
+        .rx_port = UART4_RX_GPIO_Port,
+        .rx_pin = UART4_RX_Pin,
+        .alternate = LL_GPIO_AF_5,
+        .dma = DMA1,
+        .dma_rx_channel = LL_DMA_CHANNEL_7,
+        .dma_rx_irq = DMA1_Channel7_IRQn,
+        .dma_rx_request = LL_DMAMUX_REQ_UART4_RX,
+        .dma_tx_channel = LL_DMA_CHANNEL_8,
+        .dma_tx_irq = DMA1_Channel8_IRQn,
+        .dma_tx_request = LL_DMAMUX_REQ_UART4_TX,
+        .isr_priority = ISR_UART4,
+        .isr_priority_dma_rx = ISR_UART4_DMA_RX,
+        .isr_priority_dma_tx = ISR_UART4_DMA_TX,
+        .baudrate = UART_BAUDRATE_DEFAULT,
+        .rx_buffer = uart4_rx_buffer_,
+        .rx_buffer_size = sizeof(uart4_rx_buffer_),
+    },
+    {
+        .name = "uart5",
+        .usart = UART5,
+        .usart_irq = UART5_IRQn,
+        .apb = 1,
+        .apb_periph = LL_APB1_GRP1_PERIPH_UART5,
+        .clk_source = LL_RCC_UART5_CLKSOURCE,
+        .tx_port = UART5_TX_GPIO_Port,
+        .tx_pin = UART5_TX_Pin,
+        .rx_port = UART5_RX_GPIO_Port,
+        .rx_pin = UART5_RX_Pin,
+        .alternate = LL_GPIO_AF_5,
+        .dma = DMA2,
+        .dma_rx_channel = LL_DMA_CHANNEL_1,
+        .dma_rx_irq = DMA2_Channel1_IRQn,
+        .dma_rx_request = LL_DMAMUX_REQ_UART5_RX,
+        .dma_tx_channel = LL_DMA_CHANNEL_2,
+        .dma_tx_irq = DMA2_Channel2_IRQn,
+        .dma_tx_request = LL_DMAMUX_REQ_UART5_TX,
+        .isr_priority = ISR_UART5,
+        .isr_priority_dma_rx = ISR_UART5_DMA_RX,
+        .isr_priority_dma_tx = ISR_UART5_DMA_TX,
+        .baudrate = UART_BAUDRATE_DEFAULT,
+        .rx_buffer = uart5_rx_buffer_,
+        .rx_buffer_size = sizeof(uart5_rx_buffer_),
+    },
+};
+
+static struct uart_s instances_[UART_COUNT];
+#if UART_SINGLE_TASK
+static TaskHandle_t comms_task_ = NULL;
+APP_TASK_MEMORY(comms, UART_COMMS_TASK_STACK);
+#endif
+
+
+static inline uint32_t ev(struct uart_s * self, uint32_t event) {
+    return event << self->ev_shift;
+}
+
+static inline void lock(struct uart_s * self) {
+    fbp_os_mutex_lock(self->mutex);
+}
+
+static inline void unlock(struct uart_s * self) {
+    fbp_os_mutex_unlock(self->mutex);
+}
+
+// The DMA ISR and IFCR registers have 4 flags per channel, use channel 1 flags.
+static inline uint32_t dma_flag_is_active(DMA_TypeDef * dma, uint32_t channel, uint32_t flag_ch1) {
+    return READ_BIT(dma->ISR, flag_ch1 << (channel * 4U)) ? 1U : 0U;
+}
+
+static inline void dma_flag_clear(DMA_TypeDef * dma, uint32_t channel, uint32_t flag_ch1) {
+    WRITE_REG(dma->IFCR, flag_ch1 << (channel * 4U));
+}
+
+static void gpio_init(const struct uart_config_s * config) {
+    LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
+    GPIO_InitStruct.Pin = config->tx_pin;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_NO;
+    GPIO_InitStruct.Alternate = config->alternate;
+    LL_GPIO_Init(config->tx_port, &GPIO_InitStruct);
+
+    GPIO_InitStruct.Pin = config->rx_pin;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_LOW;
+    GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;    // disable to save power
+    GPIO_InitStruct.Alternate = config->alternate;
+    LL_GPIO_Init(config->rx_port, &GPIO_InitStruct);
+}
+
+static uint32_t usart_clock(const struct uart_config_s * c) {
+    if ((c->usart == UART4) || (c->usart == UART5)) {
+        return LL_RCC_GetUARTClockFreq(c->clk_source);
+    } else {
+        return LL_RCC_GetUSARTClockFreq(c->clk_source);
+    }
+}
+
+// Oversample by 16 for noise immunity, by 8 only when the rate requires it.
+static inline uint32_t usart_oversampling(uint32_t clk, uint32_t baudrate) {
+    return (baudrate > (clk / 16)) ? LL_USART_OVERSAMPLING_8 : LL_USART_OVERSAMPLING_16;
+}
+
+/**
+  * @brief U(S)ART Initialization Function
+  * @param self The UART instance.
+  * @retval None
+  */
+static void usart_init(struct uart_s * self) {
+    const struct uart_config_s * c = self->config;
+    LL_USART_InitTypeDef USART_InitStruct = {0};
+
+    /* Peripheral clock enable */
+    if (c->apb == 2) {
+        LL_APB2_GRP1_EnableClock(c->apb_periph);
+    } else {
+        LL_APB1_GRP1_EnableClock(c->apb_periph);
+    }
+    gpio_init(c);
+
+    /* RX DMA Init */
+    LL_DMA_SetPeriphRequest(c->dma, c->dma_rx_channel, c->dma_rx_request);
+    LL_DMA_SetDataTransferDirection(c->dma, c->dma_rx_channel, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetChannelPriorityLevel(c->dma, c->dma_rx_channel, LL_DMA_PRIORITY_LOW);
+    LL_DMA_SetMode(c->dma, c->dma_rx_channel, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_SetPeriphIncMode(c->dma, c->dma_rx_channel, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(c->dma, c->dma_rx_channel, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphSize(c->dma, c->dma_rx_channel, LL_DMA_PDATAALIGN_BYTE);
+    LL_DMA_SetMemorySize(c->dma, c->dma_rx_channel, LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_SetPeriphAddress(c->dma, c->dma_rx_channel, (uint32_t) &c->usart->RDR);
+    LL_DMA_SetMemoryAddress(c->dma, c->dma_rx_channel, (uint32_t) c->rx_buffer);
+    LL_DMA_SetDataLength(c->dma, c->dma_rx_channel, c->rx_buffer_size);
+    LL_DMA_EnableIT_HT(c->dma, c->dma_rx_channel);
+    LL_DMA_EnableIT_TC(c->dma, c->dma_rx_channel);
+    LL_DMA_EnableIT_TE(c->dma, c->dma_rx_channel);
+
+    /* TX DMA Init */
+    LL_DMA_SetPeriphRequest(c->dma, c->dma_tx_channel, c->dma_tx_request);
+    LL_DMA_SetDataTransferDirection(c->dma, c->dma_tx_channel, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetChannelPriorityLevel(c->dma, c->dma_tx_channel, LL_DMA_PRIORITY_LOW);
+    LL_DMA_SetMode(c->dma, c->dma_tx_channel, LL_DMA_MODE_NORMAL);
+    LL_DMA_SetPeriphIncMode(c->dma, c->dma_tx_channel, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(c->dma, c->dma_tx_channel, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphSize(c->dma, c->dma_tx_channel, LL_DMA_PDATAALIGN_BYTE);
+    LL_DMA_SetMemorySize(c->dma, c->dma_tx_channel, LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_SetDataLength(c->dma, c->dma_tx_channel, 0); // for now
+    LL_DMA_SetPeriphAddress(c->dma, c->dma_tx_channel, (uint32_t) &c->usart->TDR);
+    LL_DMA_EnableIT_TC(c->dma, c->dma_tx_channel);
+    LL_DMA_EnableIT_TE(c->dma, c->dma_tx_channel);
+
+    USART_InitStruct.PrescalerValue = LL_USART_PRESCALER_DIV1;
+    USART_InitStruct.BaudRate = self->baudrate;
+    USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
+    USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
+    USART_InitStruct.Parity = LL_USART_PARITY_NONE;
+    USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
+    USART_InitStruct.HardwareFlowControl = LL_USART_HWCONTROL_NONE;
+    USART_InitStruct.OverSampling = usart_oversampling(usart_clock(c), self->baudrate);
+    LL_USART_Init(c->usart, &USART_InitStruct);
+    LL_USART_SetTXFIFOThreshold(c->usart, LL_USART_FIFOTHRESHOLD_1_8);
+    LL_USART_SetRXFIFOThreshold(c->usart, LL_USART_FIFOTHRESHOLD_1_8);
+#if UART_FIFO
+    LL_USART_EnableFIFO(c->usart);
+#else
+    LL_USART_DisableFIFO(c->usart);
+#endif
+    LL_USART_ConfigAsyncMode(c->usart);
+    LL_USART_EnableDMAReq_RX(c->usart);
+    LL_USART_EnableDMAReq_TX(c->usart);
+    LL_USART_SetRxTimeout(c->usart, 1);
+#if UART_FIFO
+    // The RX FIFO gives the DMA 8 bytes of latency margin.  The receiver
+    // timeout fires 1 bit after the last stop bit, before IDLE would,
+    // so it alone ends each burst with a single interrupt.
+    LL_USART_EnableRxTimeout(c->usart);
+#else
+    LL_USART_EnableIT_IDLE(c->usart);
+#endif
+    LL_USART_EnableIT_RTO(c->usart);
+    LL_USART_EnableIT_ERROR(c->usart);   // ORE, FE, NE
+
+    /* USART interrupt Init */
+    NVIC_SetPriority(c->usart_irq, c->isr_priority);
+
+    /* RX DMA interrupt init */
+    NVIC_SetPriority(c->dma_rx_irq, c->isr_priority_dma_rx);
+
+    /* TX DMA interrupt init */
+    NVIC_SetPriority(c->dma_tx_irq, c->isr_priority_dma_tx);
+    NVIC_EnableIRQ(c->usart_irq);
+    NVIC_EnableIRQ(c->dma_rx_irq);
+    NVIC_EnableIRQ(c->dma_tx_irq);
+
+    LL_DMA_EnableChannel(c->dma, c->dma_rx_channel);
+    LL_USART_Enable(c->usart);
+
+    /* Polling USART initialisation */
+    while((!(LL_USART_IsActiveFlag_TEACK(c->usart))) || (!(LL_USART_IsActiveFlag_REACK(c->usart))))
+    {
+    }
+}
+
+static inline void tx_fill_update(struct uart_s * self) {
+    uint32_t fill = self->tx_rbu8_.buf_size - 1 - fbp_rbu8_empty_size(&self->tx_rbu8_);
+    if (fill > self->tx_fill_max) {
+        self->tx_fill_max = fill;
+    }
+}
+
+static void tx_start(struct uart_s * self, uint32_t min_size) {
+    const struct uart_config_s * c = self->config;
+    uint8_t * tail = fbp_rbu8_tail(&self->tx_rbu8_);
+    uint8_t * head = fbp_rbu8_head(&self->tx_rbu8_);
+    if (tail == head) {
+        return; // empty, return
+    }
+    if (tail > head) {
+        // wrapped: send to the buffer end, then the ISR chains the start
+        self->tx_dma_next_sz = self->tx_rbu8_.head;
+        self->tx_dma_sz = self->tx_rbu8_.buf_size - self->tx_rbu8_.tail;
+    } else {
+        uint32_t sz = head - tail;
+        if (sz < min_size) {
+            return;
+        }
+        self->tx_dma_next_sz = 0;
+        self->tx_dma_sz = sz;
+    }
+    LL_DMA_DisableChannel(c->dma, c->dma_tx_channel);
+    LL_DMA_SetMemoryAddress(c->dma, c->dma_tx_channel, (uint32_t) tail);
+    LL_DMA_SetDataLength(c->dma, c->dma_tx_channel, self->tx_dma_sz);
+    dma_flag_clear(c->dma, c->dma_tx_channel, DMA_IFCR_CTEIF1 | DMA_IFCR_CHTIF1 | DMA_IFCR_CTCIF1);
+    LL_DMA_EnableChannel(c->dma, c->dma_tx_channel);
+}
+
+/**
+ * @brief Publish the RX DMA progress for rx_process().
+ *
+ * @param self The UART instance.
+ *
+ * Called from the RX DMA and USART ISRs, which run at different
+ * priorities.  The half and full transfer interrupts guarantee a call
+ * at least every half buffer, so the offset delta is the byte count.
+ * The short critical section keeps a preempted ISR from applying its
+ * delta twice.  It also captures the receive time with the count,
+ * before any task scheduling delay, for recv_fn.
+ */
+static void rx_count_publish(struct uart_s * self) {
+    const struct uart_config_s * c = self->config;
+    UBaseType_t isr_state = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t offset = c->rx_buffer_size - LL_DMA_GetDataLength(c->dma, c->dma_rx_channel);
+    if (offset >= c->rx_buffer_size) {
+        offset = 0;
+    }
+    if (offset < self->rx_dma_offset) {
+        offset += c->rx_buffer_size;
+    }
+    if (offset != self->rx_dma_offset) {
+        self->rx_time = fitterbap_support_counter().value;
+    }
+    self->rx_count += offset - self->rx_dma_offset;
+    self->rx_dma_offset = (offset >= c->rx_buffer_size) ? (offset - c->rx_buffer_size) : offset;
+    taskEXIT_CRITICAL_FROM_ISR(isr_state);
+}
+
+static inline void rx_deliver(struct uart_s * self, uint32_t offset, uint32_t size, uint64_t rx_time) {
+    if (self->recv_fn) {
+        self->recv_fn(self->recv_user_data, &self->config->rx_buffer[offset], size, rx_time);
+    }
+}
+
+/**
+ * @brief Deliver received data directly from the circular DMA buffer.
+ *
+ * @param self The UART instance.
+ *
+ * The ISRs are the only writers of rx_count and this task is the only
+ * writer of rx_consumed, so the handoff needs no lock.  A brief critical
+ * section only keeps the 64-bit receive time paired with its count.
+ * A wrapped region
+ * is delivered as two spans in the same call, which the framer parses
+ * as one continuous stream.  When the backlog exceeds the buffer, the
+ * DMA lapped unread data: drop everything and let the framer resync.
+ * The UART lock is held only to serialize recv_fn with the data link's
+ * other callers.
+ */
+static void rx_process(struct uart_s * self) {
+    uint32_t size = self->config->rx_buffer_size;
+    taskENTER_CRITICAL();
+    uint32_t count = self->rx_count;
+    uint64_t rx_time = self->rx_time;
+    taskEXIT_CRITICAL();
+    uint32_t backlog = count - self->rx_consumed;
+    if (!backlog) {
+        return;
+    }
+    if (backlog > self->rx_backlog_max) {
+        self->rx_backlog_max = backlog;
+    }
+    if (backlog > size) {
+        ++self->rx_lap;
+        self->rx_consumed = count;
+        return;
+    }
+    uint32_t tail = self->rx_consumed % size;
+    uint32_t sz = size - tail;
+    if (sz > backlog) {
+        sz = backlog;
+    }
+    uint32_t latency = (uint32_t) (fitterbap_support_counter().value - rx_time);
+    if (latency > self->rx_latency_max) {
+        self->rx_latency_max = latency;
+    }
+    lock(self);
+    rx_deliver(self, tail, sz, rx_time);
+    if (backlog > sz) {
+        rx_deliver(self, 0, backlog - sz, rx_time);
+    }
+    unlock(self);
+    self->rx_consumed = count;
+}
+
+#if UART_BENCHMARK
+#define benchmark_isr(self) (++(self)->bench_isr_count)
+#else
+#define benchmark_isr(self)
+#endif
+
+// RX DMA interrupt
+static void dma_rx_isr(struct uart_s * self) {
+    const struct uart_config_s * c = self->config;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    benchmark_isr(self);
+
+    /* Check half-transfer complete interrupt */
+    if (LL_DMA_IsEnabledIT_HT(c->dma, c->dma_rx_channel) && dma_flag_is_active(c->dma, c->dma_rx_channel, DMA_ISR_HTIF1)) {
+        dma_flag_clear(c->dma, c->dma_rx_channel, DMA_IFCR_CHTIF1);  /* Clear half-transfer complete flag */
+        rx_count_publish(self);
+        xTaskNotifyFromISR(self->task, ev(self, EV_RECV), eSetBits, &xHigherPriorityTaskWoken);
+    }
+
+    /* Check transfer-complete interrupt */
+    if (LL_DMA_IsEnabledIT_TC(c->dma, c->dma_rx_channel) && dma_flag_is_active(c->dma, c->dma_rx_channel, DMA_ISR_TCIF1)) {
+        dma_flag_clear(c->dma, c->dma_rx_channel, DMA_IFCR_CTCIF1);  /* Clear transfer complete flag */
+        rx_count_publish(self);
+        xTaskNotifyFromISR(self->task, ev(self, EV_RECV), eSetBits, &xHigherPriorityTaskWoken);
+    }
+
+    /* Check transfer error interrupt, which also disables the channel */
+    if (LL_DMA_IsEnabledIT_TE(c->dma, c->dma_rx_channel) && dma_flag_is_active(c->dma, c->dma_rx_channel, DMA_ISR_TEIF1)) {
+        dma_flag_clear(c->dma, c->dma_rx_channel, DMA_IFCR_CTEIF1);  /* Clear transfer error flag */
+        ++self->dma_te;
+        LL_DMA_EnableChannel(c->dma, c->dma_rx_channel);
+    }
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+static void usart_isr(struct uart_s * self) {
+    USART_TypeDef * usart = self->config->usart;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    benchmark_isr(self);
+    /* Check for IDLE line RX interrupt */
+    if (LL_USART_IsEnabledIT_IDLE(usart) && LL_USART_IsActiveFlag_IDLE(usart)) {
+        LL_USART_ClearFlag_IDLE(usart);      /* Clear IDLE line flag */
+        rx_count_publish(self);
+        xTaskNotifyFromISR(self->task, ev(self, EV_RECV), eSetBits, &xHigherPriorityTaskWoken);
+    }
+    /* Check for RX timeout interrupt */
+    if (LL_USART_IsEnabledIT_RTO(usart) && LL_USART_IsActiveFlag_RTO(usart)) {
+        LL_USART_ClearFlag_RTO(usart);       /* Clear RX timeout flag */
+        rx_count_publish(self);
+        xTaskNotifyFromISR(self->task, ev(self, EV_RECV), eSetBits, &xHigherPriorityTaskWoken);
+    }
+    /* Check for receive errors, counted for uart_stats() */
+    if (LL_USART_IsEnabledIT_ERROR(usart)) {
+        if (LL_USART_IsActiveFlag_ORE(usart)) {
+            LL_USART_ClearFlag_ORE(usart);
+            ++self->usart_ore;
+        }
+        if (LL_USART_IsActiveFlag_FE(usart)) {
+            LL_USART_ClearFlag_FE(usart);
+            ++self->usart_fe;
+        }
+        if (LL_USART_IsActiveFlag_NE(usart)) {
+            LL_USART_ClearFlag_NE(usart);
+            ++self->usart_ne;
+        }
+    }
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+// TX DMA interrupt
+static void dma_tx_isr(struct uart_s * self) {
+    const struct uart_config_s * c = self->config;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    benchmark_isr(self);
+    uint8_t done = 0;
+    if (LL_DMA_IsEnabledIT_TE(c->dma, c->dma_tx_channel) && dma_flag_is_active(c->dma, c->dma_tx_channel, DMA_ISR_TEIF1)) {
+        // The transfer is lost, but finish it normally so that TX continues.
+        dma_flag_clear(c->dma, c->dma_tx_channel, DMA_IFCR_CTEIF1);  /* Clear transfer error flag */
+        ++self->dma_te;
+        done = 1;
+    }
+    if (LL_DMA_IsEnabledIT_TC(c->dma, c->dma_tx_channel) && dma_flag_is_active(c->dma, c->dma_tx_channel, DMA_ISR_TCIF1)) {
+        dma_flag_clear(c->dma, c->dma_tx_channel, DMA_IFCR_CTCIF1);  /* Clear transfer complete flag */
+        done = 1;
+    }
+    if (done) {
+        uint32_t next_sz = self->tx_dma_next_sz;
+        if (next_sz) {
+            // chain the wrapped segment immediately, without a task round-trip
+            self->tx_dma_next_sz = 0;
+            self->tx_dma_sz += next_sz;
+            LL_DMA_DisableChannel(c->dma, c->dma_tx_channel);
+            LL_DMA_SetMemoryAddress(c->dma, c->dma_tx_channel, (uint32_t) self->tx_buffer);
+            LL_DMA_SetDataLength(c->dma, c->dma_tx_channel, next_sz);
+            LL_DMA_EnableChannel(c->dma, c->dma_tx_channel);
+        } else {
+#if UART_TX_ISR
+            // The ISR is the only ring consumer: advance the tail and re-arm.
+            fbp_rbu8_discard(&self->tx_rbu8_, self->tx_dma_sz);
+            self->tx_bytes += self->tx_dma_sz;
+            self->tx_dma_sz = 0;
+            tx_start(self, 0);
+            if (self->tx_blocked) {
+                self->tx_blocked = 0;
+                xTaskNotifyFromISR(self->task, ev(self, EV_SEND_DONE), eSetBits, &xHigherPriorityTaskWoken);
+            }
+#else
+            xTaskNotifyFromISR(self->task, ev(self, EV_SEND_DONE), eSetBits, &xHigherPriorityTaskWoken);
+#endif
+        }
+    }
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+void USART1_IRQHandler(void)        { usart_isr(&instances_[0]); }
+void DMA1_Channel1_IRQHandler(void) { dma_rx_isr(&instances_[0]); }
+void DMA1_Channel2_IRQHandler(void) { dma_tx_isr(&instances_[0]); }
+void USART2_IRQHandler(void)        { usart_isr(&instances_[1]); }
+void DMA1_Channel3_IRQHandler(void) { dma_rx_isr(&instances_[1]); }
+void DMA1_Channel4_IRQHandler(void) { dma_tx_isr(&instances_[1]); }
+void USART3_IRQHandler(void)        { usart_isr(&instances_[2]); }
+void DMA1_Channel5_IRQHandler(void) { dma_rx_isr(&instances_[2]); }
+void DMA1_Channel6_IRQHandler(void) { dma_tx_isr(&instances_[2]); }
+void UART4_IRQHandler(void)         { usart_isr(&instances_[3]); }
+void DMA1_Channel7_IRQHandler(void) { dma_rx_isr(&instances_[3]); }
+void DMA1_Channel8_IRQHandler(void) { dma_tx_isr(&instances_[3]); }
+void UART5_IRQHandler(void)         { usart_isr(&instances_[4]); }
+void DMA2_Channel1_IRQHandler(void) { dma_rx_isr(&instances_[4]); }
+void DMA2_Channel2_IRQHandler(void) { dma_tx_isr(&instances_[4]); }
+
+#if UART_BENCHMARK
+static void benchmark_update(struct uart_s * self) {
+    uint32_t now = xTaskGetTickCount();
+    uint32_t dt = now - self->bench_start;
+    if (dt >= configTICK_RATE_HZ) {
+        // N81 framing sends 10 bits per byte
+        uint32_t tx_bytes = self->tx_bytes;
+        uint32_t rate = (uint32_t) ((((uint64_t) (tx_bytes - self->bench_tx_bytes)) * configTICK_RATE_HZ) / dt);
+        uint32_t util = (uint32_t) ((((uint64_t) rate) * 1000) / (self->baudrate / 10));
+        FBP_LOGI("%s tx %lu B/s, utilization %lu.%lu%%", self->config->name,
+                 (unsigned long) rate, (unsigned long) (util / 10), (unsigned long) (util % 10));
+
+        // The RX backlog is the software overrun margin, ORE the hardware one.
+        uint32_t isr_count = self->bench_isr_count;
+        uint32_t isr_rate = (uint32_t) ((((uint64_t) (isr_count - self->bench_isr_count_prev)) * configTICK_RATE_HZ) / dt);
+        uint32_t ore = self->usart_ore;
+        FBP_LOGI("%s fifo=%d isr %lu/s, ore %lu, rx backlog max %lu/%lu", self->config->name, UART_FIFO,
+                 (unsigned long) isr_rate, (unsigned long) (ore - self->bench_ore_prev),
+                 (unsigned long) self->rx_backlog_max, (unsigned long) self->config->rx_buffer_size);
+        self->bench_isr_count_prev = isr_count;
+        self->bench_ore_prev = ore;
+        self->bench_tx_bytes = tx_bytes;
+        self->bench_start = now;
+    }
+}
+#else
+#define benchmark_update(self)
+#endif
+
+/**
+ * @brief Start transmission from task context if the DMA is idle.
+ *
+ * @param self The UART instance.
+ * @param min_size The minimum contiguous size to start a transfer.
+ */
+static void tx_kick(struct uart_s * self, uint32_t min_size) {
+#if UART_TX_ISR
+    taskENTER_CRITICAL();  // exclude the TX DMA ISR, which also calls tx_start()
+    if (self->tx_dma_sz == 0) {
+        tx_start(self, min_size);
+    }
+    taskEXIT_CRITICAL();
+#else
+    if (self->tx_dma_sz == 0) {
+        tx_start(self, min_size);
+    }
+#endif
+}
+
+/**
+ * @brief Compute the time until this UART next needs service.
+ *
+ * @param self The UART instance.
+ * @return The maximum time to wait, in milliseconds.
+ */
+static uint32_t service_wait_ms(struct uart_s * self) {
+    int64_t now = self->evm_api.timestamp(self->evm_api.evm);
+    int64_t duration = fbp_evm_interval_next(self->evm, now);
+    if (duration <= 0) {
+        return 0;
+    }
+    int64_t duration_ms = FBP_TIME_TO_COUNTER(duration, 1000);
+    if (duration_ms > UART_SERVICE_TIME_MAX_MS) {
+        duration_ms = UART_SERVICE_TIME_MAX_MS;
+    }
+    return (uint32_t) duration_ms;
+}
+
+/**
+ * @brief Service RX, TX and the event manager for one UART.
+ *
+ * @param self The UART instance.
+ * @param notify The events_e bits for this UART, unshifted.
+ */
+static void service(struct uart_s * self, uint32_t notify) {
+    int64_t now;
+    if (notify) {
+        lock(self);
+#if !UART_TX_ISR
+        if (notify & EV_SEND_DONE) {
+            fbp_rbu8_discard(&self->tx_rbu8_, self->tx_dma_sz);
+            self->tx_bytes += self->tx_dma_sz;
+            self->tx_dma_sz = 0;
+        }
+#endif
+        tx_kick(self, UART_TX_BUFFER_SIZE / 4);
+        unlock(self);
+
+        if (notify & EV_RECV) {
+            rx_process(self);
+        }
+    }
+
+    now = self->evm_api.timestamp(self->evm_api.evm);
+    fbp_evm_process(self->evm, now);
+
+    if (self->tx_dma_sz == 0) {
+        lock(self);
+        tx_kick(self, 0);
+        unlock(self);
+    }
+    benchmark_update(self);
+}
+
+#if UART_SINGLE_TASK
+
+static void comms_task(void *argument) {
+    (void) argument;
+    uint32_t notify;
+    uint32_t duration_ms;
+    uint32_t port_ms;
+    struct uart_s * self;
+
+    while (1) {
+        duration_ms = UART_SERVICE_TIME_MAX_MS;
+        for (uint32_t i = 0; i < UART_COUNT; ++i) {
+            self = &instances_[i];
+            if (self->running) {
+                port_ms = service_wait_ms(self);
+                if (port_ms < duration_ms) {
+                    duration_ms = port_ms;
+                }
+            }
+        }
+
+        notify = 0;
+        xTaskNotifyWait(0, 0xffffffff, &notify, duration_ms);
+
+        for (uint32_t i = 0; i < UART_COUNT; ++i) {
+            self = &instances_[i];
+            if (!self->active) {
+                continue;
+            } else if (!self->running) {
+                usart_init(self);
+                self->running = 1;
+            }
+            service(self, (notify >> self->ev_shift) & ((1U << UART_EV_BITS) - 1));
+        }
+
+        // todo watchdog pet, regardless of data send/receive
+    }
+}
+
+#else
+
+static void uart_task(void *argument) {
+    struct uart_s * self = (struct uart_s *) argument;
+    uint32_t notify;
+
+    usart_init(self);
+    self->running = 1;
+
+    while (1) {
+        notify = 0;
+        xTaskNotifyWait(0, 0xffffffff, &notify, service_wait_ms(self));
+        service(self, notify);
+
+        // todo watchdog pet, regardless of data send/receive
+    }
+}
+
+#endif
+
+/**
+ * @brief Apply a pending baud rate once the transmitter is idle.
+ *
+ * @param user_data The UART instance.
+ * @param event_id The event manager event id, unused.
+ *
+ * Runs on the UART task from the event manager.  New TX data is held
+ * off until the switch completes, and the data link retransmits any
+ * frames lost while the two link ends run at different rates.
+ */
+static void on_baudrate_switch(void * user_data, int32_t event_id) {
+    (void) event_id;
+    struct uart_s * self = (struct uart_s *) user_data;
+    USART_TypeDef * usart = self->config->usart;
+    uint32_t baudrate = self->baudrate_pending;
+    if (!baudrate) {
+        return;
+    }
+    self->tx_hold = 1;
+    if (self->tx_dma_sz || fbp_rbu8_size(&self->tx_rbu8_) || !LL_USART_IsActiveFlag_TC(usart)) {
+        int64_t now = self->evm_api.timestamp(self->evm_api.evm);
+        self->evm_api.schedule(self->evm_api.evm, now + FBP_TIME_MILLISECOND, on_baudrate_switch, self);
+        return;
+    }
+
+    uint32_t clk = usart_clock(self->config);
+    uint32_t oversampling = usart_oversampling(clk, baudrate);
+    LL_USART_Disable(usart);
+    LL_USART_SetOverSampling(usart, oversampling);
+    LL_USART_SetBaudRate(usart, clk, LL_USART_PRESCALER_DIV1, oversampling, baudrate);
+    LL_USART_Enable(usart);
+    while ((!(LL_USART_IsActiveFlag_TEACK(usart))) || (!(LL_USART_IsActiveFlag_REACK(usart)))) {
+    }
+    self->baudrate = baudrate;
+    self->baudrate_pending = 0;
+    self->tx_hold = 0;
+    FBP_LOGI("%s baud %lu", self->config->name, (unsigned long) baudrate);
+}
+
+static void on_schedule(void * user_data, int64_t next_time) {
+    struct uart_s * self = (struct uart_s *) user_data;
+    (void) next_time;
+    if (self->task) {
+        xTaskNotify(self->task, ev(self, EV_APP), eSetBits);
+    }
+}
+
+struct uart_s * uart_get(uint32_t index) {
+    if (index >= UART_COUNT) {
+        return NULL;
+    }
+    return &instances_[index];
+}
+
+void uart_initialize(struct uart_s * self) {
+    fbp_memset(self, 0, sizeof(*self));
+    self->config = &configs_[self - instances_];
+    self->baudrate = self->config->baudrate;
+    fbp_rbu8_init(&self->tx_rbu8_, self->tx_buffer, sizeof(self->tx_buffer));
+
+    self->mutex = app_mutex_alloc();
+    self->evm = fbp_evm_allocate();
+    FBP_ASSERT(0 == fbp_evm_api_get(self->evm, &self->evm_api));
+    fbp_evm_register_mutex(self->evm, self->mutex);
+    fbp_evm_register_schedule_callback(self->evm, on_schedule, self);
+
+#if UART_SINGLE_TASK
+    // One task services every port, each port owns UART_EV_BITS notification bits.
+    self->ev_shift = (uint8_t) ((self - instances_) * UART_EV_BITS);
+    if (!comms_task_) {
+        if (pdTRUE != app_task_create(
+                comms_task,             /* pvTaskCode */
+                "comms",                /* pcName */
+                UART_COMMS_TASK_STACK,  /* usStackDepth in 32-bit words */
+                NULL,                   /* pvParameters */
+                UART_TASK_PRIORITY,     /* uxPriority */
+                &comms_task_,           /* pxCreatedTask */
+                APP_TASK_STACK(comms),
+                APP_TASK_TCB(comms))) {
+            FBP_FATAL("comms task");
+        }
+    }
+    self->task = comms_task_;
+    self->active = 1;
+    xTaskNotify(self->task, ev(self, EV_APP), eSetBits);  // start the hardware
+#else
+    self->active = 1;
+#if APP_STATIC_ALLOC
+    StackType_t * stack = self->task_stack;
+    StaticTask_t * tcb = &self->task_tcb;
+#else
+    StackType_t * stack = NULL;
+    StaticTask_t * tcb = NULL;
+#endif
+    if (pdTRUE != app_task_create(
+            uart_task,              /* pvTaskCode */
+            self->config->name,     /* pcName */
+            UART_TASK_STACK,        /* usStackDepth in 32-bit words */
+            self,                   /* pvParameters */
+            UART_TASK_PRIORITY,     /* uxPriority */
+            &self->task,            /* pxCreatedTask */
+            stack,
+            tcb)) {
+        FBP_FATAL("uart task");
+    }
+#endif
+}
+
+void uart_evm_api(struct uart_s * self, struct fbp_evm_api_s * api) {
+    *api = self->evm_api;
+}
+
+void uart_recv_register(struct uart_s * self, uart_recv_fn recv_fn, void * recv_user_data) {
+    lock(self);
+    self->recv_fn = NULL;
+    self->recv_user_data = recv_user_data;
+    self->recv_fn = recv_fn;
+    unlock(self);
+}
+
+int32_t uart_send(struct uart_s * self, uint8_t const *buffer, uint32_t buffer_size) {
+    int32_t rv = 0;
+    lock(self);
+    if (self->tx_hold) {
+        rv = FBP_ERROR_NOT_ENOUGH_MEMORY;
+    } else if (fbp_rbu8_add(&self->tx_rbu8_, buffer, buffer_size)) {
+        tx_fill_update(self);
+#if UART_TX_ISR
+        tx_kick(self, 0);
+#else
+        xTaskNotify(self->task, ev(self, EV_SEND), eSetBits);
+#endif
+    } else {
+        self->tx_blocked = 1;
+        rv = FBP_ERROR_NOT_ENOUGH_MEMORY;
+    }
+    unlock(self);
+    return rv;
+}
+
+uint32_t uart_send_available(struct uart_s * self) {
+    lock(self);
+    uint32_t sz = self->tx_hold ? 0 : fbp_rbu8_empty_size(&self->tx_rbu8_);
+    if (sz < (UART_TX_BUFFER_SIZE / 2)) {
+        self->tx_blocked = 1;  // wake the task when space frees up
+    }
+    unlock(self);
+    return sz;
+}
+
+void uart_mutex(struct uart_s * self, fbp_os_mutex_t * mutex) {
+    *mutex = self->mutex;
+}
+
+void uart_stats(struct uart_s * self, struct uart_stats_s * stats) {
+    stats->rx_bytes = self->rx_count;
+    stats->tx_bytes = self->tx_bytes;
+    stats->rx_lap = self->rx_lap;
+    stats->rx_overrun = self->usart_ore;
+    stats->rx_framing = self->usart_fe;
+    stats->rx_noise = self->usart_ne;
+    stats->dma_error = self->dma_te;
+    stats->rx_backlog_max = self->rx_backlog_max;
+    stats->tx_fill_max = self->tx_fill_max;
+    struct fbp_time_counter_s counter = fitterbap_support_counter();
+    stats->rx_latency_max = (uint32_t) ((((uint64_t) self->rx_latency_max) * 1000000U) / counter.frequency);
+}
+
+int32_t uart_baudrate_set(struct uart_s * self, uint32_t baudrate) {
+    uint32_t clk = usart_clock(self->config);
+    if ((baudrate < UART_BAUDRATE_MIN) || (baudrate > UART_BAUDRATE_MAX)
+            || (baudrate > (clk / 8)) || (baudrate < ((clk / 0xffff) + 1))) {
+        return FBP_ERROR_PARAMETER_INVALID;
+    } else if (baudrate == self->baudrate) {
+        self->baudrate_pending = 0;
+        return 0;
+    }
+    self->baudrate_pending = baudrate;
+    int64_t now = self->evm_api.timestamp(self->evm_api.evm);
+    self->evm_api.schedule(self->evm_api.evm, now + UART_BAUD_SWITCH_DELAY_MS * FBP_TIME_MILLISECOND,
+                           on_baudrate_switch, self);
+    return 0;
+}
+
+uint32_t uart_baudrate_get(struct uart_s * self) {
+    return self->baudrate;
+}
@@ -178,6 +178,14 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+#if defined(APP_STATIC_ALLOC) && APP_STATIC_ALLOC
+/* Only the kernel objects created inside fitterbap and CMSIS-RTOS remain, see App/Inc/app_os.h */
+#ifndef APP_STATIC_HEAP_SIZE
+#define APP_STATIC_HEAP_SIZE (4096)
+#endif
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE ((size_t) APP_STATIC_HEAP_SIZE)
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
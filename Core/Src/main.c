@@ -26,8 +26,11 @@
 #include "led.h"
 #include "fitterbap_support.h"
 #include "app_comms.h"
+#include "app_os.h"
 #include "button_service.h"
+#include "crc32.h"
 #include "led_service.h"
+#include "sys_service.h"
 #include "fitterbap/log.h"
 
 /* USER CODE END Includes */
@@ -98,6 +101,7 @@ int main(void)
 
   /* USER CODE BEGIN SysInit */
     fitterbap_support_initialize();
+    crc32_initialize();
 
   /* USER CODE END SysInit */
 
@@ -108,6 +112,7 @@ int main(void)
     app_pubsub_initialize();
     led_service_initialize();
     button_service_initialize();
+    sys_service_initialize();
     app_comms_initialize();
 
   /* USER CODE END 2 */
@@ -327,10 +332,13 @@ static void MX_GPIO_Init(void)
 void StartDefaultTask(void *argument)
 {
   /* USER CODE BEGIN 5 */
+  app_heap_check();
+  crc32_benchmark();
   /* Infinite loop */
   for(;;)
   {
     button_service_poll();
+    sys_service_poll();
     osDelay(50);
   }
   /* USER CODE END 5 */
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host stand-in for the CMSIS-RTOS2 header.
+ *
+ * The application only uses the CMSIS priority levels, which map
+ * directly onto FreeRTOS priorities.
+ */
+
+#ifndef FBP_EXAMPLE_HOST_CMSIS_OS_H__
+#define FBP_EXAMPLE_HOST_CMSIS_OS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    osPriorityNone          =  0,
+    osPriorityIdle          =  1,
+    osPriorityLow           =  8,
+    osPriorityBelowNormal   = 16,
+    osPriorityNormal        = 24,
+    osPriorityAboveNormal   = 32,
+    osPriorityHigh          = 40,
+    osPriorityRealtime      = 48,
+} osPriority_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FBP_EXAMPLE_HOST_CMSIS_OS_H__ */
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host stand-in for Core/Inc/main.h with the pins used by App/.
+ */
+
+#ifndef FBP_EXAMPLE_HOST_MAIN_H__
+#define FBP_EXAMPLE_HOST_MAIN_H__
+
+#include "stm32g4xx_ll_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define B1_Pin LL_GPIO_PIN_13
+#define B1_GPIO_Port GPIOC
+#define LD2_Pin LL_GPIO_PIN_5
+#define LD2_GPIO_Port GPIOA
+#define ID0_Pin LL_GPIO_PIN_0
+#define ID0_GPIO_Port GPIOB
+#define ID1_Pin LL_GPIO_PIN_1
+#define ID1_GPIO_Port GPIOB
+#define ID2_Pin LL_GPIO_PIN_2
+#define ID2_GPIO_Port GPIOB
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FBP_EXAMPLE_HOST_MAIN_H__ */
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host stand-in for the STM32 LL GPIO driver.
+ *
+ * Each port is a pair of input/output registers in RAM.  Host code
+ * drives the inputs, such as the board ID pins, from the command line.
+ */
+
+#ifndef FBP_EXAMPLE_HOST_LL_GPIO_H__
+#define FBP_EXAMPLE_HOST_LL_GPIO_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef host_gpio[4];
+
+#define GPIOA (&host_gpio[0])
+#define GPIOB (&host_gpio[1])
+#define GPIOC (&host_gpio[2])
+#define GPIOD (&host_gpio[3])
+
+#define LL_GPIO_PIN_0       (1U << 0)
+#define LL_GPIO_PIN_1       (1U << 1)
+#define LL_GPIO_PIN_2       (1U << 2)
+#define LL_GPIO_PIN_3       (1U << 3)
+#define LL_GPIO_PIN_4       (1U << 4)
+#define LL_GPIO_PIN_5       (1U << 5)
+#define LL_GPIO_PIN_6       (1U << 6)
+#define LL_GPIO_PIN_7       (1U << 7)
+#define LL_GPIO_PIN_8       (1U << 8)
+#define LL_GPIO_PIN_9       (1U << 9)
+#define LL_GPIO_PIN_10      (1U << 10)
+#define LL_GPIO_PIN_11      (1U << 11)
+#define LL_GPIO_PIN_12      (1U << 12)
+#define LL_GPIO_PIN_13      (1U << 13)
+#define LL_GPIO_PIN_14      (1U << 14)
+#define LL_GPIO_PIN_15      (1U << 15)
+
+static inline uint32_t LL_GPIO_IsInputPinSet(GPIO_TypeDef *GPIOx, uint32_t PinMask) {
+    return ((GPIOx->IDR & PinMask) == PinMask) ? 1U : 0U;
+}
+
+static inline void LL_GPIO_SetOutputPin(GPIO_TypeDef *GPIOx, uint32_t PinMask) {
+    GPIOx->ODR |= PinMask;
+}
+
+static inline void LL_GPIO_ResetOutputPin(GPIO_TypeDef *GPIOx, uint32_t PinMask) {
+    GPIOx->ODR &= ~PinMask;
+}
+
+static inline void LL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint32_t PinMask) {
+    GPIOx->ODR ^= PinMask;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FBP_EXAMPLE_HOST_LL_GPIO_H__ */
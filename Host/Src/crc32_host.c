@@ -0,0 +1,77 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host replacement for App/Src/crc32.c using the software backend.
+ */
+
+#include "crc32.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/crc.h"
+#include "fitterbap/log.h"
+#include <time.h>
+
+#define CRC32_BENCHMARK (0)         // 1 to log ns per byte from crc32_benchmark()
+#define CRC32_BENCHMARK_SIZE (256)
+#define CRC32_BENCHMARK_ITERATIONS (4096)
+#define CRC32_CHECK_VALUE (0xCBF43926U)  // CRC-32 of "123456789"
+
+
+uint32_t app_crc32(uint32_t crc, uint8_t const * data, uint32_t length) {
+    return crc32_sw(crc, data, length);
+}
+
+void crc32_initialize() {
+    crc32_sw_initialize();
+    if (CRC32_CHECK_VALUE != app_crc32(0, (uint8_t const *) "123456789", 9)) {
+        FBP_FATAL("crc32");
+    }
+}
+
+#if CRC32_BENCHMARK
+
+typedef uint32_t (*crc32_fn)(uint32_t crc, uint8_t const * data, uint32_t length);
+
+static void benchmark_run(const char * name, crc32_fn fn, uint8_t const * data) {
+    struct timespec t_start;
+    struct timespec t_end;
+    uint32_t rv = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (uint32_t i = 0; i < CRC32_BENCHMARK_ITERATIONS; ++i) {
+        rv = fn(rv, data, CRC32_BENCHMARK_SIZE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    int64_t ns = (t_end.tv_sec - t_start.tv_sec) * 1000000000LL + (t_end.tv_nsec - t_start.tv_nsec);
+    uint32_t ps_per_byte = (uint32_t) ((ns * 1000) / (CRC32_BENCHMARK_ITERATIONS * CRC32_BENCHMARK_SIZE));
+    FBP_LOGI("crc32 %s: %lu ps/byte, crc=0x%08lx", name, (unsigned long) ps_per_byte, (unsigned long) rv);
+}
+
+void crc32_benchmark() {
+    static uint32_t buffer_u32[CRC32_BENCHMARK_SIZE / 4];
+    uint8_t * buffer = (uint8_t *) buffer_u32;
+    for (uint32_t i = 0; i < CRC32_BENCHMARK_SIZE; ++i) {
+        buffer[i] = (uint8_t) (i * 7);
+    }
+    benchmark_run("fbp_crc32", fbp_crc32, buffer);
+    benchmark_run("slicing8", crc32_sw, buffer);
+}
+
+#else
+
+void crc32_benchmark() {
+}
+
+#endif
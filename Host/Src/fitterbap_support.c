@@ -0,0 +1,82 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fitterbap_support.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/log.h"
+#include "fitterbap/time.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+void fbp_fatal(char const * file, int line, char const * msg) {
+    fprintf(stderr, "FATAL %s:%d: %s\n", file, line, msg);
+    fflush(stderr);
+    abort();
+}
+
+static void * hal_alloc(fbp_size_t size_bytes) {
+    void * p = pvPortMalloc((size_t) size_bytes);
+    if (!p) {
+        size_t sz = xPortGetFreeHeapSize();
+        FBP_LOGE("alloc(%d) but only %d remain", (int) size_bytes, (int) sz);
+        FBP_FATAL("alloc");
+    }
+    return p;
+}
+
+static void hal_free(void * ptr) {
+    FBP_FATAL("free");
+    vPortFree(ptr);
+}
+
+/*
+ * The counters are relative to fitterbap_support_initialize(), since
+ * CLOCK_MONOTONIC starts at boot.  fbp_time_counter() runs at 1 kHz so
+ * that fitterbap's (value << 30) / frequency conversion to FBP_TIME
+ * cannot overflow, see App/Src/fitterbap_support.c.
+ */
+#define FBP_COUNTER_FREQUENCY (1000U)
+#define NS_PER_COUNT (1000000000U / FBP_COUNTER_FREQUENCY)
+
+static uint64_t time_base_ns_ = 0;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec) * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+void fitterbap_support_initialize() {
+    fbp_allocator_set(hal_alloc, hal_free);
+    time_base_ns_ = now_ns();
+}
+
+struct fbp_time_counter_s fitterbap_support_counter() {
+    struct fbp_time_counter_s counter;
+    counter.value = now_ns() - time_base_ns_;
+    counter.frequency = 1000000000ULL;
+    return counter;
+}
+
+FBP_API struct fbp_time_counter_s fbp_time_counter() {
+    struct fbp_time_counter_s counter = fitterbap_support_counter();
+    counter.value /= NS_PER_COUNT;
+    counter.frequency = FBP_COUNTER_FREQUENCY;
+    return counter;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host entry point, the equivalent of Core/Src/main.c.
+ *
+ * Usage: fitterbap_example_host [--id {0..7}] [--watch {topic}]
+ *
+ * The ID selects the board prefix, just like the ID0..ID2 pins.
+ * Watch prints the numeric values under the local topic, such as
+ * "sys" or "c1/stats", at most once per WATCH_INTERVAL_MS per topic.
+ */
+
+#include "main.h"
+#include "app_comms.h"
+#include "app_os.h"
+#include "button_service.h"
+#include "crc32.h"
+#include "fitterbap_support.h"
+#include "led_service.h"
+#include "sys_service.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TASK_STACK (256)
+#define DEFAULT_TASK_PRIORITY ((osPriority_t) osPriorityNormal)
+#define WATCH_INTERVAL_MS (2000)
+
+GPIO_TypeDef host_gpio[4];
+
+static void default_task(void *argument) {
+    (void) argument;
+    app_heap_check();
+    crc32_benchmark();
+    while (1) {
+        button_service_poll();
+        sys_service_poll();
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+}
+
+static uint8_t on_watch(void * user_data, const char * topic, const struct fbp_union_s * value) {
+    (void) user_data;
+    switch (value->type) {
+        case FBP_UNION_F32: printf("%s %g\n", topic, (double) value->value.f32); break;
+        case FBP_UNION_F64: printf("%s %g\n", topic, value->value.f64); break;
+        case FBP_UNION_U8:  printf("%s %u\n", topic, (unsigned) value->value.u8); break;
+        case FBP_UNION_U16: printf("%s %u\n", topic, (unsigned) value->value.u16); break;
+        case FBP_UNION_U32: printf("%s %lu\n", topic, (unsigned long) value->value.u32); break;
+        case FBP_UNION_U64: printf("%s %llu\n", topic, (unsigned long long) value->value.u64); break;
+        case FBP_UNION_I8:  printf("%s %d\n", topic, (int) value->value.i8); break;
+        case FBP_UNION_I16: printf("%s %d\n", topic, (int) value->value.i16); break;
+        case FBP_UNION_I32: printf("%s %ld\n", topic, (long) value->value.i32); break;
+        case FBP_UNION_I64: printf("%s %lld\n", topic, (long long) value->value.i64); break;
+        default: break;
+    }
+    return 0;
+}
+
+static int usage(const char * name) {
+    fprintf(stderr, "usage: %s [--id {0..7}] [--watch {topic}]\n", name);
+    return 1;
+}
+
+int main(int argc, char * argv[]) {
+    uint32_t id = 0;
+    const char * watch = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "--id")) && ((i + 1) < argc)) {
+            id = (uint32_t) strtoul(argv[++i], NULL, 0);
+            if (id > 7) {
+                return usage(argv[0]);
+            }
+        } else if ((0 == strcmp(argv[i], "--watch")) && ((i + 1) < argc)) {
+            watch = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    ID0_GPIO_Port->IDR |= (id & 1) ? ID0_Pin : 0;
+    ID1_GPIO_Port->IDR |= (id & 2) ? ID1_Pin : 0;
+    ID2_GPIO_Port->IDR |= (id & 4) ? ID2_Pin : 0;
+
+    fitterbap_support_initialize();
+    crc32_initialize();
+    app_pubsub_initialize();
+    led_service_initialize();
+    button_service_initialize();
+    sys_service_initialize();
+    app_comms_initialize();
+    if (watch && app_subscribe_throttled(watch, FBP_PUBSUB_SFLAG_RETAIN, WATCH_INTERVAL_MS, on_watch, NULL)) {
+        return usage(argv[0]);
+    }
+
+    if (pdTRUE != xTaskCreate(
+            default_task,           /* pvTaskCode */
+            "default",              /* pcName */
+            DEFAULT_TASK_STACK,     /* usStackDepth in words */
+            NULL,                   /* pvParameters */
+            DEFAULT_TASK_PRIORITY,  /* uxPriority */
+            NULL)) {
+        return 1;
+    }
+    vTaskStartScheduler();
+    return 1;
+}
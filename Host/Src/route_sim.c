@@ -0,0 +1,257 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host simulator for the prefix routing table.
+ *
+ * Usage: route_sim
+ *
+ * Wires 8 virtual boards, 'a' to 'h', into a ring and a star, runs
+ * the distance vector exchange to convergence and reports the
+ * bytes on the wire for one publish:
+ *
+ *   flood:  every board forwards on all other ports with a hop
+ *           limit, which is all that stops a ring from looping.
+ *   rpf:    traffic for all boards with route_flood_mask().
+ *   routed: traffic for one board with route_next_hop(), averaged
+ *           over all source and destination pairs.
+ *
+ * Like the firmware, even ports are servers and odd ports are
+ * clients, and each link connects a server to a client.  A board
+ * only has 5 ports, so the star hub 'a' serves b to f directly
+ * while g and h hang off b and c.  The ring then loses one link
+ * to check reconvergence.  Returns nonzero if any publish fails to
+ * reach its destination exactly once.
+ */
+
+#include "route.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BOARD_COUNT (ROUTE_PREFIX_COUNT)
+#define ROUNDS_MAX (64)
+#define QUEUE_SIZE (4096)
+#define FLOOD_HOP_LIMIT (BOARD_COUNT)
+// A representative u32 publish: data link framing, port header, topic and value.
+#define PUBLISH_BYTES (40)
+// A vector advertisement: data link framing, port header and the hop counts.
+#define ADVERTISE_BYTES (16 + ROUTE_PREFIX_COUNT)
+
+struct link_s {
+    int8_t board;   // peer board or -1
+    uint8_t port;   // peer port
+};
+
+struct board_s {
+    struct route_s route;
+    struct link_s link[ROUTE_PORT_COUNT];
+};
+
+struct msg_s {
+    uint8_t board;
+    uint8_t port;
+    uint8_t ttl;
+};
+
+static struct board_s boards_[BOARD_COUNT];
+static struct msg_s queue_[QUEUE_SIZE];
+static uint32_t errors_ = 0;
+
+static void reset() {
+    for (int b = 0; b < BOARD_COUNT; ++b) {
+        route_initialize(&boards_[b].route, (char) ('a' + b));
+        for (int p = 0; p < ROUTE_PORT_COUNT; ++p) {
+            boards_[b].link[p].board = -1;
+        }
+    }
+}
+
+static void connect(int server, int server_port, int client, int client_port) {
+    if ((server_port & 1) || !(client_port & 1)) {
+        printf("invalid link %c.%d -> %c.%d\n", 'a' + server, server_port, 'a' + client, client_port);
+        ++errors_;
+        return;
+    }
+    boards_[server].link[server_port] = (struct link_s) {.board = client, .port = client_port};
+    boards_[client].link[client_port] = (struct link_s) {.board = server, .port = server_port};
+    route_port_set(&boards_[server].route, server_port, 1);
+    route_port_set(&boards_[client].route, client_port, 1);
+}
+
+static void disconnect(int board, int port) {
+    struct link_s * link = &boards_[board].link[port];
+    struct link_s * peer = &boards_[link->board].link[link->port];
+    route_port_set(&boards_[link->board].route, link->port, 0);
+    route_port_set(&boards_[board].route, port, 0);
+    peer->board = -1;
+    link->board = -1;
+}
+
+// Exchange vectors in synchronous rounds until no table changes.
+static uint32_t converge(uint32_t * bytes) {
+    uint8_t hops[BOARD_COUNT][ROUTE_PORT_COUNT][ROUTE_PREFIX_COUNT];
+    for (uint32_t round = 1; round <= ROUNDS_MAX; ++round) {
+        int changed = 0;
+        for (int b = 0; b < BOARD_COUNT; ++b) {
+            for (int p = 0; p < ROUTE_PORT_COUNT; ++p) {
+                route_advertise(&boards_[b].route, p, hops[b][p]);
+            }
+        }
+        for (int b = 0; b < BOARD_COUNT; ++b) {
+            for (int p = 0; p < ROUTE_PORT_COUNT; ++p) {
+                struct link_s * link = &boards_[b].link[p];
+                if (link->board >= 0) {
+                    *bytes += ADVERTISE_BYTES;
+                    changed |= route_update(&boards_[link->board].route, link->port, hops[b][p]);
+                }
+            }
+        }
+        if (!changed) {
+            return round;
+        }
+    }
+    printf("routing did not converge\n");
+    ++errors_;
+    return ROUNDS_MAX;
+}
+
+static uint32_t flood(int src, uint32_t * received) {
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t tx = 0;
+    queue_[tail++] = (struct msg_s) {.board = src, .port = ROUTE_PORT_NONE, .ttl = FLOOD_HOP_LIMIT};
+    while (head != tail) {
+        struct msg_s m = queue_[head++];
+        if (m.port != ROUTE_PORT_NONE) {
+            ++received[m.board];
+            if (!--m.ttl) {
+                continue;
+            }
+        }
+        for (int p = 0; p < ROUTE_PORT_COUNT; ++p) {
+            struct link_s * link = &boards_[m.board].link[p];
+            if ((p != m.port) && (link->board >= 0) && (tail < QUEUE_SIZE)) {
+                ++tx;
+                queue_[tail++] = (struct msg_s) {.board = link->board, .port = link->port, .ttl = m.ttl};
+            }
+        }
+    }
+    return tx;
+}
+
+static uint32_t rpf(int src, uint32_t * received) {
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t tx = 0;
+    char prefix = (char) ('a' + src);
+    queue_[tail++] = (struct msg_s) {.board = src, .port = ROUTE_PORT_NONE};
+    while (head != tail) {
+        struct msg_s m = queue_[head++];
+        struct route_s * route = &boards_[m.board].route;
+        if ((m.port != ROUTE_PORT_NONE) && (m.port == route_next_hop(route, prefix))) {
+            ++received[m.board];
+        }
+        uint8_t mask = route_flood_mask(route, prefix, m.port);
+        for (int p = 0; p < ROUTE_PORT_COUNT; ++p) {
+            struct link_s * link = &boards_[m.board].link[p];
+            if ((mask & (1 << p)) && (link->board >= 0) && (tail < QUEUE_SIZE)) {
+                ++tx;
+                queue_[tail++] = (struct msg_s) {.board = link->board, .port = link->port};
+            }
+        }
+    }
+    return tx;
+}
+
+static uint32_t routed(int src, int dst) {
+    uint32_t tx = 0;
+    int b = src;
+    while (b != dst) {
+        uint8_t port = route_next_hop(&boards_[b].route, (char) ('a' + dst));
+        if ((port == ROUTE_PORT_NONE) || (tx >= ROUTE_HOPS_MAX)) {
+            printf("no route %c -> %c\n", 'a' + src, 'a' + dst);
+            ++errors_;
+            return tx;
+        }
+        b = boards_[b].link[port].board;
+        ++tx;
+    }
+    return tx;
+}
+
+static void report(const char * name) {
+    uint32_t ctrl_bytes = 0;
+    uint32_t rounds = converge(&ctrl_bytes);
+    uint32_t flood_tx = 0;
+    uint32_t flood_dup = 0;
+    uint32_t rpf_tx = 0;
+    uint32_t routed_tx = 0;
+
+    for (int src = 0; src < BOARD_COUNT; ++src) {
+        uint32_t flood_rx[BOARD_COUNT] = {0};
+        uint32_t rpf_rx[BOARD_COUNT] = {0};
+        flood_tx += flood(src, flood_rx);
+        rpf_tx += rpf(src, rpf_rx);
+        for (int dst = 0; dst < BOARD_COUNT; ++dst) {
+            if (dst == src) {
+                continue;
+            }
+            if (flood_rx[dst] > 1) {
+                flood_dup += flood_rx[dst] - 1;
+            }
+            if (rpf_rx[dst] != 1) {
+                printf("rpf %c -> %c received %u times\n", 'a' + src, 'a' + dst, (unsigned) rpf_rx[dst]);
+                ++errors_;
+            }
+            routed_tx += routed(src, dst);
+        }
+    }
+
+    uint32_t pairs = BOARD_COUNT * (BOARD_COUNT - 1);
+    printf("%s: converged in %u rounds, %u control bytes\n",
+           name, (unsigned) rounds, (unsigned) ctrl_bytes);
+    printf("  flood  %7.1f bytes/publish, %5.1f duplicates/publish\n",
+           (double) (flood_tx * PUBLISH_BYTES) / BOARD_COUNT, (double) flood_dup / BOARD_COUNT);
+    printf("  rpf    %7.1f bytes/publish\n", (double) (rpf_tx * PUBLISH_BYTES) / BOARD_COUNT);
+    printf("  routed %7.1f bytes/publish\n", (double) (routed_tx * PUBLISH_BYTES) / pairs);
+}
+
+int main(void) {
+    reset();
+    for (int b = 0; b < BOARD_COUNT; ++b) {
+        connect(b, 0, (b + 1) % BOARD_COUNT, 1);
+    }
+    report("ring");
+
+    disconnect(BOARD_COUNT - 1, 0);
+    report("ring, h-a cut");
+
+    reset();
+    connect(0, 0, 1, 1);
+    connect(2, 0, 0, 1);
+    connect(0, 2, 3, 1);
+    connect(4, 0, 0, 3);
+    connect(0, 4, 5, 1);
+    connect(1, 0, 6, 1);
+    connect(2, 2, 7, 1);
+    report("star");
+
+    if (errors_) {
+        printf("FAIL: %u errors\n", (unsigned) errors_);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host benchmark for PubSub topic lookup.
+ *
+ * Usage: topic_index_bench [topic_count]
+ *
+ * Registers topic_count retained topics spread over the c1/ to cN/
+ * subtrees, one per UART, then reports the mean latency of
+ * fbp_pubsub_query, fbp_pubsub_publish + fbp_pubsub_process and
+ * topic_index_find for the same topics.
+ */
+
+#include "topic_index.h"
+#include "uart.h"
+#include "fitterbap/pubsub.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/platform.h"
+#include "fitterbap/time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TOPIC_COUNT_DEFAULT (1000)
+#define ITERATIONS (200000)
+#define ENTRY_COUNT (4096)
+#define ARENA_SIZE (ENTRY_COUNT * 24)
+
+static struct topic_index_entry_s entries_[ENTRY_COUNT];
+static char arena_[ARENA_SIZE];
+static char (*topics_)[FBP_PUBSUB_TOPIC_LENGTH_MAX];
+
+void fbp_fatal(char const * file, int line, char const * msg) {
+    fprintf(stderr, "FATAL %s:%d: %s\n", file, line, msg);
+    abort();
+}
+
+static void * hal_alloc(fbp_size_t size_bytes) {
+    void * p = malloc((size_t) size_bytes);
+    if (!p) {
+        FBP_FATAL("alloc");
+    }
+    return p;
+}
+
+static void hal_free(void * ptr) {
+    free(ptr);
+}
+
+static int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t) ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+FBP_API struct fbp_time_counter_s fbp_time_counter() {
+    struct fbp_time_counter_s counter;
+    counter.value = (uint64_t) now_ns();
+    counter.frequency = 1000000000ULL;
+    return counter;
+}
+
+int64_t fbp_time_utc() {
+    return 0;
+}
+
+static void report(const char * name, int64_t t_start, uint32_t count) {
+    int64_t dt = now_ns() - t_start;
+    printf("%-16s %8.1f ns/op\n", name, ((double) dt) / count);
+}
+
+int main(int argc, char * argv[]) {
+    uint32_t topic_count = TOPIC_COUNT_DEFAULT;
+    struct topic_index_s index;
+    struct fbp_union_s value;
+    int64_t t_start;
+    volatile uintptr_t sink = 0;
+
+    if (argc > 1) {
+        topic_count = (uint32_t) strtoul(argv[1], NULL, 0);
+    }
+    if (!topic_count || ((topic_count * 4) > (ENTRY_COUNT * 3))) {
+        fprintf(stderr, "topic_count must be 1 to %d\n", (ENTRY_COUNT * 3) / 4);
+        return 1;
+    }
+    fbp_allocator_set(hal_alloc, hal_free);
+    topics_ = malloc(topic_count * sizeof(*topics_));
+    struct fbp_pubsub_s * pubsub = fbp_pubsub_initialize("a", 65536);
+    topic_index_initialize(&index, entries_, ENTRY_COUNT, arena_, sizeof(arena_));
+
+    for (uint32_t i = 0; i < topic_count; ++i) {
+        snprintf(topics_[i], sizeof(topics_[i]), "a/c%u/t%u/v", (unsigned) ((i % UART_COUNT) + 1), (unsigned) i);
+        fbp_pubsub_publish(pubsub, topics_[i], &fbp_union_u32_r(i), NULL, NULL);
+        fbp_pubsub_process(pubsub);
+        topic_index_add(&index, topics_[i], &topics_[i]);
+    }
+    printf("%u topics, %d iterations\n", (unsigned) topic_count, ITERATIONS);
+
+    t_start = now_ns();
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        fbp_pubsub_query(pubsub, topics_[i % topic_count], &value);
+    }
+    report("pubsub query", t_start, ITERATIONS);
+
+    t_start = now_ns();
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        fbp_pubsub_publish(pubsub, topics_[i % topic_count], &fbp_union_u32_r(i), NULL, NULL);
+        fbp_pubsub_process(pubsub);
+    }
+    report("pubsub publish", t_start, ITERATIONS);
+
+    t_start = now_ns();
+    for (uint32_t i = 0; i < ITERATIONS; ++i) {
+        sink += (uintptr_t) topic_index_find(&index, topics_[i % topic_count]);
+    }
+    report("topic_index find", t_start, ITERATIONS);
+    return 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host simulator for hierarchical time synchronization.
+ *
+ * Usage: tsync_sim [duration_s]
+ *
+ * A time root serves a chain of 8 boards, 'a' to 'h'.  Each board has
+ * its upstream on client port 1 and its downstream on server port 0.
+ * Board 'e' also has client port 3 wired to server port 2 of 'b', so
+ * it must elect the shorter path.  Every board clock has a different
+ * frequency error.  Each link adds a fixed frame time.  Half of the
+ * exchanges also see task scheduling delay, as when the timestamps
+ * are taken in the UART tasks instead of the ISRs.
+ *
+ * Each board runs one exchange per second with its upstream.  The
+ * report shows the offset error from the root time per hop, over the
+ * second half of the run, for tsync and for the raw last exchange.
+ */
+
+#include "tsync.h"
+#include "fitterbap/time.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BOARD_COUNT (9)                 // root + 'a' to 'h'
+#define DURATION_DEFAULT (1200)         // seconds
+#define FRAME_TIME (100e-6)             // seconds, one link traversal
+#define PROCESS_TIME (20e-6)            // seconds, upstream turnaround
+#define SCHEDULE_DELAY_MEAN (500e-6)    // seconds, task scheduling delay
+
+struct link_s {
+    int8_t board;   // upstream board or -1
+};
+
+struct board_s {
+    struct tsync_s tsync;
+    double ppm;                         // clock frequency error
+    double phase;                       // clock offset at time 0, seconds
+    struct link_s link[TSYNC_PORT_COUNT];
+    int64_t raw_offset;                 // the last exchange offset, unfiltered
+    int raw_valid;
+    double err_sum2;
+    double err_max;
+    double raw_sum2;
+    double raw_max;
+    uint32_t err_count;
+};
+
+static struct board_s boards_[BOARD_COUNT];
+static uint64_t rand_state_ = 0x2545f4914f6cdd1dULL;
+
+static double rand_uniform() {
+    rand_state_ ^= rand_state_ << 13;
+    rand_state_ ^= rand_state_ >> 7;
+    rand_state_ ^= rand_state_ << 17;
+    return (double) (rand_state_ >> 11) / (double) (1ULL << 53);
+}
+
+static double link_delay() {
+    double d = FRAME_TIME;
+    if (rand_uniform() < 0.5) {
+        d += -SCHEDULE_DELAY_MEAN * log(1.0 - rand_uniform());
+    }
+    return d;
+}
+
+static inline int64_t to_time(double t) {
+    return (int64_t) llround(t * (double) FBP_TIME_SECOND);
+}
+
+static inline double to_us(int64_t t) {
+    return ((double) t * 1e6) / (double) FBP_TIME_SECOND;
+}
+
+static int64_t local_time(struct board_s * b, double t) {
+    return to_time((t + b->phase) * (1.0 + b->ppm * 1e-6));
+}
+
+static int64_t served_time(struct board_s * b, double t) {
+    return tsync_time(&b->tsync, local_time(b, t));
+}
+
+static int64_t raw_time(struct board_s * b, double t) {
+    int64_t local = local_time(b, t);
+    return b->raw_valid ? (local + b->raw_offset) : local;
+}
+
+static const char * board_name(int idx) {
+    static const char * NAMES[BOARD_COUNT] = {"root", "a", "b", "c", "d", "e", "f", "g", "h"};
+    return NAMES[idx];
+}
+
+static void wire(int upstream, int upstream_port, int downstream, int downstream_port) {
+    (void) upstream_port;
+    boards_[downstream].link[downstream_port].board = (int8_t) upstream;
+}
+
+static void elect() {
+    for (int round = 0; round < BOARD_COUNT; ++round) {
+        for (int b = 0; b < BOARD_COUNT; ++b) {
+            for (uint8_t p = 0; p < TSYNC_PORT_COUNT; ++p) {
+                int8_t u = boards_[b].link[p].board;
+                if (u >= 0) {
+                    tsync_port_set(&boards_[b].tsync, p, 1, boards_[u].tsync.stratum);
+                }
+            }
+        }
+    }
+}
+
+static void exchange(int idx, double t) {
+    struct board_s * b = &boards_[idx];
+    uint8_t port = b->tsync.port;
+    if (port == TSYNC_PORT_NONE) {
+        return;
+    }
+    struct board_s * u = &boards_[b->link[port].board];
+    double d1 = link_delay();
+    double d2 = link_delay();
+
+    int64_t t1 = local_time(b, t);
+    int64_t t2 = served_time(u, t + d1);
+    int64_t t3 = served_time(u, t + d1 + PROCESS_TIME);
+    int64_t t4 = local_time(b, t + d1 + PROCESS_TIME + d2);
+    tsync_update(&b->tsync, port, t1, t2, t3, t4);
+
+    // the same exchange against the raw upstream time, without filtering
+    t2 = raw_time(u, t + d1);
+    t3 = raw_time(u, t + d1 + PROCESS_TIME);
+    b->raw_offset = ((t2 - t1) + (t3 - t4)) / 2;
+    b->raw_valid = 1;
+}
+
+static void measure(int idx, double t) {
+    struct board_s * b = &boards_[idx];
+    double err = fabs(to_us(served_time(b, t) - to_time(t)));
+    double raw = fabs(to_us(raw_time(b, t) - to_time(t)));
+    b->err_sum2 += err * err;
+    b->raw_sum2 += raw * raw;
+    b->err_max = (err > b->err_max) ? err : b->err_max;
+    b->raw_max = (raw > b->raw_max) ? raw : b->raw_max;
+    ++b->err_count;
+}
+
+int main(int argc, char * argv[]) {
+    int duration = DURATION_DEFAULT;
+    if (argc > 1) {
+        duration = atoi(argv[1]);
+    }
+    if (duration < 20) {
+        fprintf(stderr, "duration must be at least 20 seconds\n");
+        return 1;
+    }
+
+    for (int idx = 0; idx < BOARD_COUNT; ++idx) {
+        struct board_s * b = &boards_[idx];
+        tsync_initialize(&b->tsync, idx == 0);
+        for (int p = 0; p < TSYNC_PORT_COUNT; ++p) {
+            b->link[p].board = -1;
+        }
+        if (idx) {
+            b->ppm = (rand_uniform() - 0.5) * 100.0;   // +/- 50 ppm crystals
+            b->phase = rand_uniform() * 10.0;
+            wire(idx - 1, 0, idx, 1);
+        }
+    }
+    wire(2, 2, 5, 3);  // shortcut b -> e
+    elect();
+
+    for (int s = 0; s < duration; ++s) {
+        for (int idx = 1; idx < BOARD_COUNT; ++idx) {
+            double t = s + idx * 0.01;
+            exchange(idx, t);
+            if (s >= (duration / 2)) {
+                measure(idx, t + 0.5);  // halfway between exchanges
+            }
+        }
+    }
+
+    printf("board stratum port | tsync rms/max us | raw rms/max us\n");
+    for (int idx = 1; idx < BOARD_COUNT; ++idx) {
+        struct board_s * b = &boards_[idx];
+        printf("%-5s %7u %4u | %7.2f %7.2f | %7.2f %7.2f\n",
+               board_name(idx), (unsigned) b->tsync.stratum, (unsigned) b->tsync.port,
+               sqrt(b->err_sum2 / b->err_count), b->err_max,
+               sqrt(b->raw_sum2 / b->err_count), b->raw_max);
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2021 Jetperch LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host replacement for App/Src/uart.c.
+ *
+ * Each UART is the master side of a pseudo-terminal.  Connect
+ * pyfitterbap, or another host instance through socat, to the
+ * slave device printed at startup.  The POSIX port does not allow
+ * blocking system calls from tasks, so each UART task polls its
+ * non-blocking file descriptor once per tick.
+ */
+
+#define _GNU_SOURCE
+#include "uart.h"
+#include "fitterbap_support.h"
+#include "fitterbap/assert.h"
+#include "fitterbap/cdef.h"
+#include "fitterbap/ec.h"
+#include "fitterbap/time.h"
+#include "fitterbap/collections/ring_buffer_u8.h"
+
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+#define UART_TASK_STACK (512)
+#define UART_TASK_PRIORITY ((osPriority_t) osPriorityNormal)
+#define UART_POLL_TIME_MS (1)
+#define UART_RX_BUFFER_SIZE  (256)
+#define UART_TX_BUFFER_SIZE  ((270 + 16) * 2)
+
+
+struct uart_s {
+    uint8_t id;
+    int fd;
+    uart_recv_fn recv_fn;
+    void * recv_user_data;
+    TaskHandle_t task;
+    uint8_t rx_buffer[UART_RX_BUFFER_SIZE];
+    uint8_t tx_buffer[UART_TX_BUFFER_SIZE];
+    struct fbp_rbu8_s tx_rbu8_;
+    uint32_t rx_bytes;
+    uint32_t tx_bytes;
+    uint32_t tx_fill_max;
+    uint32_t baudrate;
+    struct fbp_evm_s * evm;
+    struct fbp_evm_api_s evm_api;
+    fbp_os_mutex_t mutex;
+};
+
+enum events_e {
+    EV_SEND = (1 << 1),
+    EV_APP = (1 << 3),
+};
+
+static struct uart_s instances_[UART_COUNT];
+
+
+static void pty_open(struct uart_s * self) {
+    struct termios tio;
+    self->fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((self->fd < 0) || grantpt(self->fd) || unlockpt(self->fd)) {
+        FBP_FATAL("pty open");
+    }
+    if (0 == tcgetattr(self->fd, &tio)) {
+        cfmakeraw(&tio);
+        tcsetattr(self->fd, TCSANOW, &tio);
+    }
+    printf("uart%d: %s\n", (int) self->id, ptsname(self->fd));
+    fflush(stdout);
+}
+
+static void rx_process(struct uart_s * self) {
+    while (1) {
+        ssize_t sz = read(self->fd, self->rx_buffer, sizeof(self->rx_buffer));
+        if (sz <= 0) {
+            // EAGAIN when empty, EIO when the slave side is not open
+            return;
+        }
+        self->rx_bytes += (uint32_t) sz;
+        if (self->recv_fn) {
+            self->recv_fn(self->recv_user_data, self->rx_buffer, (uint32_t) sz,
+                          fitterbap_support_counter().value);
+        }
+    }
+}
+
+static void tx_process(struct uart_s * self) {
+    while (1) {
+        uint8_t * tail = fbp_rbu8_tail(&self->tx_rbu8_);
+        uint8_t * head = fbp_rbu8_head(&self->tx_rbu8_);
+        uint32_t sz;
+        if (tail == head) {
+            return;
+        } else if (tail > head) {
+            sz = self->tx_rbu8_.buf_size - self->tx_rbu8_.tail;
+        } else {
+            sz = head - tail;
+        }
+        ssize_t rv = write(self->fd, tail, sz);
+        if (rv <= 0) {
+            if ((rv < 0) && (errno == EAGAIN)) {
+                return;  // pty full, retry next poll
+            }
+            // slave side not open: drop the data, like an unconnected wire
+            rv = sz;
+        }
+        fbp_rbu8_discard(&self->tx_rbu8_, (uint32_t) rv);
+        self->tx_bytes += (uint32_t) rv;
+    }
+}
+
+static void tx_fill_update(struct uart_s * self) {
+    uint32_t fill = self->tx_rbu8_.buf_size - 1 - fbp_rbu8_empty_size(&self->tx_rbu8_);
+    if (fill > self->tx_fill_max) {
+        self->tx_fill_max = fill;
+    }
+}
+
+static void uart_task(void *argument) {
+    struct uart_s * self = (struct uart_s *) argument;
+    uint32_t notify;
+    uint32_t duration_ms;
+    int64_t now;
+    int64_t duration;
+
+    pty_open(self);
+
+    while (1) {
+        notify = 0;
+        now = self->evm_api.timestamp(self->evm_api.evm);
+        duration = fbp_evm_interval_next(self->evm, now);
+        duration_ms = FBP_TIME_TO_COUNTER(duration, 1000);
+        if (duration_ms > UART_POLL_TIME_MS) {
+            duration_ms = UART_POLL_TIME_MS;
+        }
+        xTaskNotifyWait(0, 0xffffffff, &notify, duration_ms);
+
+        fbp_os_mutex_lock(self->mutex);
+        rx_process(self);
+        tx_process(self);
+        fbp_os_mutex_unlock(self->mutex);
+
+        now = self->evm_api.timestamp(self->evm_api.evm);
+        fbp_evm_process(self->evm, now);
+
+        fbp_os_mutex_lock(self->mutex);
+        tx_process(self);
+        fbp_os_mutex_unlock(self->mutex);
+    }
+}
+
+static void on_schedule(void * user_data, int64_t next_time) {
+    struct uart_s * self = (struct uart_s *) user_data;
+    (void) next_time;
+    if (self->task) {
+        xTaskNotify(self->task, EV_APP, eSetBits);
+    }
+}
+
+struct uart_s * uart_get(uint32_t index) {
+    if (index >= UART_COUNT) {
+        return NULL;
+    }
+    return &instances_[index];
+}
+
+void uart_initialize(struct uart_s * self) {
+    char name[8];
+    fbp_memset(self, 0, sizeof(*self));
+    self->id = (uint8_t) (self - instances_) + 1;
+    self->fd = -1;
+    self->baudrate = UART_BAUDRATE_DEFAULT;
+    fbp_rbu8_init(&self->tx_rbu8_, self->tx_buffer, sizeof(self->tx_buffer));
+
+    self->mutex = fbp_os_mutex_alloc();
+    self->evm = fbp_evm_allocate();
+    FBP_ASSERT(0 == fbp_evm_api_get(self->evm, &self->evm_api));
+    fbp_evm_register_mutex(self->evm, self->mutex);
+    fbp_evm_register_schedule_callback(self->evm, on_schedule, self);
+
+    snprintf(name, sizeof(name), "uart%d", (int) self->id);
+    if (pdTRUE != xTaskCreate(
+            uart_task,              /* pvTaskCode */
+            name,                   /* pcName */
+            UART_TASK_STACK,        /* usStackDepth in words */
+            self,                   /* pvParameters */
+            UART_TASK_PRIORITY,     /* uxPriority */
+            &self->task)) {
+        FBP_FATAL("uart task");
+    }
+}
+
+void uart_evm_api(struct uart_s * self, struct fbp_evm_api_s * api) {
+    *api = self->evm_api;
+}
+
+void uart_recv_register(struct uart_s * self, uart_recv_fn recv_fn, void * recv_user_data) {
+    fbp_os_mutex_lock(self->mutex);
+    self->recv_fn = NULL;
+    self->recv_user_data = recv_user_data;
+    self->recv_fn = recv_fn;
+    fbp_os_mutex_unlock(self->mutex);
+}
+
+int32_t uart_send(struct uart_s * self, uint8_t const *buffer, uint32_t buffer_size) {
+    int32_t rv = 0;
+    fbp_os_mutex_lock(self->mutex);
+    if (fbp_rbu8_add(&self->tx_rbu8_, buffer, buffer_size)) {
+        tx_fill_update(self);
+        xTaskNotify(self->task, EV_SEND, eSetBits);
+    } else {
+        rv = FBP_ERROR_NOT_ENOUGH_MEMORY;
+    }
+    fbp_os_mutex_unlock(self->mutex);
+    return rv;
+}
+
+uint32_t uart_send_available(struct uart_s * self) {
+    fbp_os_mutex_lock(self->mutex);
+    uint32_t sz = fbp_rbu8_empty_size(&self->tx_rbu8_);
+    fbp_os_mutex_unlock(self->mutex);
+    return sz;
+}
+
+void uart_mutex(struct uart_s * self, fbp_os_mutex_t * mutex) {
+    *mutex = self->mutex;
+}
+
+void uart_stats(struct uart_s * self, struct uart_stats_s * stats) {
+    // A pseudo-terminal has no line errors and the kernel buffers RX.
+    // The receive time is taken in this task, so rx_latency_max is 0.
+    fbp_memset(stats, 0, sizeof(*stats));
+    stats->rx_bytes = self->rx_bytes;
+    stats->tx_bytes = self->tx_bytes;
+    stats->tx_fill_max = self->tx_fill_max;
+}
+
+int32_t uart_baudrate_set(struct uart_s * self, uint32_t baudrate) {
+    // Pseudo-terminals ignore the baud rate, but keep the PubSub contract.
+    if ((baudrate < UART_BAUDRATE_MIN) || (baudrate > UART_BAUDRATE_MAX)) {
+        return FBP_ERROR_PARAMETER_INVALID;
+    }
+    self->baudrate = baudrate;
+    return 0;
+}
+
+uint32_t uart_baudrate_get(struct uart_s * self) {
+    return self->baudrate;
+}
@@ -0,0 +1,96 @@
+# Copyright 2021 Jetperch LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Host build that runs the application and all five comm stacks on the
+# FreeRTOS POSIX port.  Pseudo-terminals replace the UART peripherals.
+# Included from the top-level CMakeLists.txt when FBP_EXAMPLE_HOST is ON.
+
+set(FREERTOS_KERNEL_PATH "" CACHE PATH "Path to a FreeRTOS-Kernel checkout")
+set(FREERTOS_PORT_PATH ${FREERTOS_KERNEL_PATH}/portable/ThirdParty/GCC/Posix)
+if (NOT EXISTS "${FREERTOS_PORT_PATH}/port.c")
+    message(FATAL_ERROR "Set FREERTOS_KERNEL_PATH to a FreeRTOS-Kernel checkout with the POSIX port")
+endif ()
+
+find_package(Threads REQUIRED)
+set(PLATFORM "FREERTOS")
+
+if ("${CMAKE_BUILD_TYPE}" STREQUAL "Release")
+    add_compile_options(-O2)
+else ()
+    add_compile_options(-Og -g)
+endif ()
+add_compile_options(-Wall)
+
+include_directories(
+        Host/Inc
+        App/Inc
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_PORT_PATH}
+        ${FREERTOS_PORT_PATH}/utils)
+
+file(GLOB FREERTOS_PORT_SOURCES "${FREERTOS_PORT_PATH}/*.c" "${FREERTOS_PORT_PATH}/utils/*.c")
+set(FREERTOS_SOURCES
+        ${FREERTOS_KERNEL_PATH}/event_groups.c
+        ${FREERTOS_KERNEL_PATH}/list.c
+        ${FREERTOS_KERNEL_PATH}/queue.c
+        ${FREERTOS_KERNEL_PATH}/stream_buffer.c
+        ${FREERTOS_KERNEL_PATH}/tasks.c
+        ${FREERTOS_KERNEL_PATH}/timers.c
+        ${FREERTOS_KERNEL_PATH}/portable/MemMang/heap_1.c
+        ${FREERTOS_PORT_SOURCES}
+        )
+
+set(HOST_SOURCES
+        App/Src/app_comms.c
+        App/Src/app_os.c
+        App/Src/button_service.c
+        App/Src/crc32_sw.c
+        App/Src/led_service.c
+        App/Src/log_bin.c
+        App/Src/log_handler.c
+        App/Src/log_ring.c
+        App/Src/sys_service.c
+        App/Src/topic_index.c
+        Host/Src/crc32_host.c
+        Host/Src/fitterbap_support.c
+        Host/Src/main.c
+        Host/Src/uart_host.c
+        fitterbap/third-party/tinyprintf/tinyprintf.c
+        )
+
+if (FBP_EXAMPLE_USE_DIRECT)
+    message(STATUS "fitterbap use direct")
+    add_subdirectory(../fitterbap ext/fitterbap)
+    include_directories(${FITTERBAP_INCLUDE})
+else ()
+    message(STATUS "fitterbap use submodule")
+    add_subdirectory(fitterbap)
+    include_directories(${FITTERBAP_INCLUDE})
+endif ()
+
+add_executable(fitterbap_example_host ${HOST_SOURCES} ${FREERTOS_SOURCES})
+add_dependencies(fitterbap_example_host fitterbap)
+target_link_libraries(fitterbap_example_host fitterbap Threads::Threads)
+
+# PubSub topic lookup benchmark, see Host/Src/topic_bench.c
+add_executable(topic_index_bench Host/Src/topic_bench.c App/Src/topic_index.c ${FREERTOS_SOURCES})
+add_dependencies(topic_index_bench fitterbap)
+target_link_libraries(topic_index_bench fitterbap Threads::Threads)
+
+# Prefix routing simulator for 8 boards, see Host/Src/route_sim.c
+add_executable(route_sim Host/Src/route_sim.c App/Src/route.c)
+
+# Hierarchical time sync simulator for a chain of boards, see Host/Src/tsync_sim.c
+add_executable(tsync_sim Host/Src/tsync_sim.c App/Src/tsync.c)
+target_link_libraries(tsync_sim m)
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+# Copyright 2021 Jetperch LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decode binary log records, see App/Inc/log_bin.h.
+
+Usage: log_bin_decode.py {elf} {records}
+
+The records file contains the concatenated "{prefix}/log/bin" payloads.
+From a pyfitterbap subscriber, use FormatTable(elf).decode(payload).
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+
+LEVELS = 'EACEWNIDDD'  # matches the fitterbap log level characters
+SECTION = 'log_fmt'
+SEP = '\x1f'
+SPEC = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z|j|t)?([diouxXcspfFeEgG%])')
+
+
+def elf_section(path, name):
+    """Return the contents of an ELF section by name."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF':
+        raise ValueError('not an ELF file')
+    is64 = data[4] == 2
+    endian = '<' if data[5] == 1 else '>'
+    if is64:
+        shoff, = struct.unpack_from(endian + 'Q', data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', data, 0x3A)
+        fmt = endian + 'IIQQQQIIQQ'
+    else:
+        shoff, = struct.unpack_from(endian + 'I', data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', data, 0x2E)
+        fmt = endian + 'IIIIIIIIII'
+    sections = [struct.unpack_from(fmt, data, shoff + i * shentsize) for i in range(shnum)]
+    strtab = sections[shstrndx]
+    names = data[strtab[4]:strtab[4] + strtab[5]]
+    for s in sections:
+        s_name = names[s[0]:names.index(b'\0', s[0])].decode('utf-8')
+        if s_name == name:
+            return data[s[4]:s[4] + s[5]]
+    raise ValueError(f'section {name} not found')
+
+
+class FormatTable:
+    """The log_fmt strings, by offset."""
+
+    def __init__(self, elf):
+        self._data = elf_section(elf, SECTION)
+
+    def lookup(self, offset):
+        end = self._data.index(b'\0', offset)
+        fmt, filename, line = self._data[offset:end].decode('utf-8').split(SEP)
+        return fmt, filename.replace('\\', '/').split('/')[-1], int(line)
+
+    def decode(self, payload):
+        """Yield (time_ms, level, filename, line, message) for each record."""
+        idx = 0
+        while idx + 8 <= len(payload):
+            level, size, offset, time_ms = struct.unpack_from('<BBHI', payload, idx)
+            if size < 8:
+                raise ValueError(f'invalid record size {size} at {idx}')
+            args = payload[idx + 8:idx + size]
+            idx += size
+            fmt, filename, line = self.lookup(offset)
+            yield time_ms, level, filename, line, render(fmt, args)
+
+
+def render(fmt, args):
+    """Render a C format string with the packed record arguments."""
+    pos = 0
+    out = []
+    last = 0
+
+    def take(n):
+        nonlocal pos
+        if pos + n > len(args):
+            raise IndexError
+        v = args[pos:pos + n]
+        pos += n
+        return v
+
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, precision, length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        try:
+            if width == '*':
+                width = str(struct.unpack('<i', take(4))[0])
+            if precision == '*':
+                precision = str(struct.unpack('<i', take(4))[0])
+            spec = '%' + flags + (width or '') + ('.' + precision if precision else '')
+            if conv == 's':
+                end = args.index(b'\0', pos)
+                value = take(end - pos + 1)[:-1].decode('utf-8', errors='replace')
+                out.append((spec + 's') % value)
+            elif conv in 'fFeEgG':
+                out.append((spec + conv) % struct.unpack('<d', take(8))[0])
+            else:
+                size = 8 if length == 'll' else 4
+                signed = conv in 'di'
+                value = int.from_bytes(take(size), 'little', signed=signed)
+                if conv == 'c':
+                    out.append((spec + 'c') % chr(value & 0xff))
+                elif conv == 'p':
+                    out.append((spec + 's') % f'0x{value:08x}')
+                else:
+                    out.append((spec + ('d' if conv in 'diu' else conv)) % value)
+        except (IndexError, ValueError):
+            out.append('?')
+    out.append(fmt[last:])
+    return ''.join(out).rstrip('\n')
+
+
+def get_parser():
+    p = argparse.ArgumentParser(description='Decode binary log records.')
+    p.add_argument('elf', help='The firmware ELF file.')
+    p.add_argument('records', help='The binary log records file.')
+    return p
+
+
+def run():
+    args = get_parser().parse_args()
+    table = FormatTable(args.elf)
+    with open(args.records, 'rb') as f:
+        payload = f.read()
+    for time_ms, level, filename, line, msg in table.decode(payload):
+        level_char = LEVELS[level] if level < len(LEVELS) else '?'
+        print(f'{time_ms / 1000:10.3f} {level_char} {filename}:{line}: {msg}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(run())
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# Copyright 2021 Jetperch LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Report the RAM used by each module from a GNU ld map file.
+
+Usage: ram_budget.py {map} [-o {report}]
+
+The build runs this script after each link.  Statically allocated
+tasks, see App/Inc/app_os.h, appear in the module that creates them.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+RAM_REGION = re.compile(r'^(\w*RAM\w*)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+OUTPUT_SECTION = re.compile(r'^(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?')
+INPUT_SECTION = re.compile(r'^ (\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.+))?)?$')
+CONTINUATION = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.+))?$')
+RAM_SECTIONS_DEFAULT = ['.data', '.bss', '.noinit']
+COLUMNS = ['.data', '.bss', '.noinit', 'other']
+
+
+def module_name(path):
+    """Convert an object file path to a module name."""
+    path = path.strip().replace('\\', '/')
+    m = re.match(r'(.*)\((.*)\)$', path)
+    if m:  # archive member: lib/libfitterbap.a(pubsub.c.obj)
+        lib = os.path.basename(m.group(1))
+        lib = re.sub(r'^lib|\.a$', '', lib)
+        return f'{lib}/{re.sub(r"[.](obj|o)$", "", m.group(2))}'
+    path = re.sub(r'[.](obj|o)$', '', path)
+    if 'CMakeFiles/' in path:
+        return re.sub(r'^.*CMakeFiles/[^/]+[.]dir/', '', path)
+    return os.path.basename(path)  # toolchain startup files
+
+
+def parse(f):
+    """Parse the map file.
+
+    :return: (ram, sections) where ram is (origin, length) or None and
+        sections is a list of (output_name, address, size, inputs) with
+        inputs as a list of (module, size).
+    """
+    ram = None
+    sections = []
+    state = 'start'
+    pending = None      # name waiting for its address and size
+    pending_output = False
+    current = None
+    for line in f:
+        line = line.rstrip()
+        if state == 'start':
+            if line.startswith('Memory Configuration'):
+                state = 'memory'
+            continue
+        if state == 'memory':
+            m = RAM_REGION.match(line)
+            if m and ram is None:
+                ram = (int(m.group(2), 16), int(m.group(3), 16))
+            if line.startswith('Linker script and memory map'):
+                state = 'map'
+            continue
+        if pending is not None:
+            m = CONTINUATION.match(line)
+            pending_name, pending = pending, None
+            if m:
+                addr, size = int(m.group(1), 16), int(m.group(2), 16)
+                if pending_output:
+                    current = [pending_name, addr, size, []]
+                    sections.append(current)
+                elif current is not None:
+                    current[3].append((module_name(m.group(3) or '(linker)'), size))
+                continue
+        if not line or line.startswith('OUTPUT(') or line.startswith('LOAD '):
+            continue
+        if line[0] == '.':
+            m = OUTPUT_SECTION.match(line)
+            if m.group(2) is None:
+                pending, pending_output = m.group(1), True
+            else:
+                current = [m.group(1), int(m.group(2), 16), int(m.group(3), 16), []]
+                sections.append(current)
+            continue
+        if line[0] != ' ' or line[1] == ' ' or current is None:
+            continue
+        m = INPUT_SECTION.match(line)
+        if not m or m.group(1).startswith('*('):
+            continue
+        name = m.group(1)
+        if m.group(2) is None:
+            if not name.startswith('*'):
+                pending, pending_output = name, False
+            continue
+        size = int(m.group(3), 16)
+        if name == '*fill*':
+            current[3].append(('(fill)', size))
+        elif m.group(4):
+            current[3].append((module_name(m.group(4)), size))
+    return ram, sections
+
+
+def is_ram(ram, name, addr, size):
+    if ram is None:
+        return name in RAM_SECTIONS_DEFAULT
+    origin, length = ram
+    return size and origin <= addr < origin + length
+
+
+def budget(ram, sections):
+    """Compute {module: {column: bytes}} and the total RAM use."""
+    modules = {}
+    used = 0
+    for name, addr, size, inputs in sections:
+        if not is_ram(ram, name, addr, size):
+            continue
+        used += size
+        column = name if name in COLUMNS else 'other'
+        for module, sz in inputs:
+            modules.setdefault(module, dict.fromkeys(COLUMNS, 0))[column] += sz
+        reserved = size - sum(sz for _, sz in inputs)
+        if reserved > 0:  # space from linker script assignments, like the stack
+            modules.setdefault(f'({name})', dict.fromkeys(COLUMNS, 0))[column] += reserved
+    return modules, used
+
+
+def report(ram, modules, used, out):
+    rows = sorted(modules.items(), key=lambda kv: -sum(kv[1].values()))
+    width = max([len('module')] + [len(k) for k in modules])
+    header = f'{"module":<{width}} ' + ' '.join(f'{c:>8}' for c in COLUMNS) + f' {"total":>8}'
+    print(header, file=out)
+    print('-' * len(header), file=out)
+    for module, cols in rows:
+        total = sum(cols.values())
+        if not total:
+            continue
+        print(f'{module:<{width}} ' + ' '.join(f'{cols[c]:8d}' for c in COLUMNS) + f' {total:8d}', file=out)
+    print('-' * len(header), file=out)
+    totals = {c: sum(m[c] for m in modules.values()) for c in COLUMNS}
+    print(f'{"total":<{width}} ' + ' '.join(f'{totals[c]:8d}' for c in COLUMNS) + f' {used:8d}', file=out)
+    if ram is not None:
+        size = ram[1]
+        print(f'RAM {size} bytes, {used} used, {size - used} free ({100.0 * (size - used) / size:.1f} %)',
+              file=out)
+
+
+def get_parser():
+    p = argparse.ArgumentParser(description='Report the RAM used by each module from a GNU ld map file.')
+    p.add_argument('map', help='The linker map file.')
+    p.add_argument('-o', '--output', help='Also write the report to this file.')
+    return p
+
+
+def run():
+    args = get_parser().parse_args()
+    with open(args.map, 'rt') as f:
+        ram, sections = parse(f)
+    modules, used = budget(ram, sections)
+    report(ram, modules, used, sys.stdout)
+    if args.output:
+        with open(args.output, 'wt') as f:
+            report(ram, modules, used, f)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(run())